@@ -1,5 +1,6 @@
 /* ascon.c */
 #include "ascon.h"
+#include "rtprof.h"
 
 /* ------------------------------------------------------------------ */
 /*  Internal helpers (static)                                         */
@@ -43,11 +44,13 @@ static void linear_layer(bit64 s[5]) {
 }
 
 static void p_perm(bit64 s[5], int rounds) {
+  RTPROF_BEGIN(RTPROF_ASCON_PERM);
   for(int r = 0; r < rounds; r++){
     add_constant(s, r, rounds);
     sbox_layer(s);
     linear_layer(s);
   }
+  RTPROF_END(RTPROF_ASCON_PERM);
 }
 
 /* ------------------------------------------------------------------ */
@@ -86,12 +89,15 @@ void ascon_encrypt(bit64 s[5],
 
 void ascon_decrypt(bit64 s[5],
                    const bit64 *ct, bit64 *pt, int len) {
-  pt[0] = ct[0] ^ s[0];
-  s[0]  = ct[0];
+  /* read ct[i] before writing pt[i] so ct == pt (in place) works */
+  bit64 c = ct[0];
+  pt[0] = c ^ s[0];
+  s[0]  = c;
   for(int i = 1; i < len; i++) {
     p_perm(s, 6);
-    pt[i] = ct[i] ^ s[0];
-    s[0]  = ct[i];
+    c     = ct[i];
+    pt[i] = c ^ s[0];
+    s[0]  = c;
   }
 }
 
@@ -102,3 +108,198 @@ void ascon_finalization(bit64 s[5], const bit64 k[2]) {
   s[3] ^= k[0];
   s[4] ^= k[1];
 }
+
+/* ------------------------------------------------------------------ */
+/*  ASCON-Hash / ASCON-XOF / keyed MAC (sponge over the same p_perm)  */
+/* ------------------------------------------------------------------ */
+
+#define ASCON_HASH_IV 0x00400c0000000100ULL
+#define ASCON_XOF_IV  0x00400c0000000000ULL
+
+static void hash_start(ascon_hash_ctx *ctx, bit64 iv) {
+  ctx->s[0] = iv;
+  ctx->s[1] = ctx->s[2] = ctx->s[3] = ctx->s[4] = 0;
+  p_perm(ctx->s, 12);
+  ctx->pos = 0;
+  ctx->squeezing = 0;
+}
+
+void ascon_hash_init(ascon_hash_ctx *ctx) {
+  hash_start(ctx, ASCON_HASH_IV);
+}
+
+void ascon_xof_init(ascon_hash_ctx *ctx) {
+  hash_start(ctx, ASCON_XOF_IV);
+}
+
+void ascon_hash_update(ascon_hash_ctx *ctx,
+                       const uint8_t *in, size_t len) {
+  RTPROF_BEGIN(RTPROF_ASCON_ABSORB);
+  while(len) {
+    if(ctx->pos == 0 && len >= ASCON_HASH_RATE) {
+      /* whole block: big-endian word straight into the rate */
+      bit64 w = 0;
+      for(int i = 0; i < ASCON_HASH_RATE; i++) w = (w << 8) | in[i];
+      ctx->s[0] ^= w;
+      p_perm(ctx->s, 12);
+      in  += ASCON_HASH_RATE;
+      len -= ASCON_HASH_RATE;
+      continue;
+    }
+    ctx->s[0] ^= (bit64)*in++ << (56 - 8 * ctx->pos);
+    len--;
+    if(++ctx->pos == ASCON_HASH_RATE) {
+      p_perm(ctx->s, 12);
+      ctx->pos = 0;
+    }
+  }
+  RTPROF_END(RTPROF_ASCON_ABSORB);
+}
+
+void ascon_xof_squeeze(ascon_hash_ctx *ctx, uint8_t *out, size_t len) {
+  if(!ctx->squeezing) {
+    /* pad the last (possibly empty) block */
+    ctx->s[0] ^= 0x80ULL << (56 - 8 * ctx->pos);
+    p_perm(ctx->s, 12);
+    ctx->pos = 0;
+    ctx->squeezing = 1;
+  }
+  while(len--) {
+    if(ctx->pos == ASCON_HASH_RATE) {
+      p_perm(ctx->s, 12);
+      ctx->pos = 0;
+    }
+    *out++ = ctx->s[0] >> (56 - 8 * ctx->pos++);
+  }
+}
+
+void ascon_hash_final(ascon_hash_ctx *ctx, uint8_t out[ASCON_HASH_LEN]) {
+  ascon_xof_squeeze(ctx, out, ASCON_HASH_LEN);
+}
+
+void ascon_mac_init(ascon_hash_ctx *ctx, const uint8_t key[16]) {
+  ascon_xof_init(ctx);
+  ascon_hash_update(ctx, key, 16);
+}
+
+void ascon_mac_final(ascon_hash_ctx *ctx, uint8_t tag[ASCON_MAC_LEN]) {
+  ascon_xof_squeeze(ctx, tag, ASCON_MAC_LEN);
+}
+
+int ascon_mac_verify(ascon_hash_ctx *ctx, const uint8_t tag[ASCON_MAC_LEN]) {
+  uint8_t t[ASCON_MAC_LEN];
+  uint8_t diff = 0;
+  ascon_mac_final(ctx, t);
+  for(int i = 0; i < ASCON_MAC_LEN; i++) diff |= t[i] ^ tag[i];
+  return diff ? -1 : 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  ASCON-128 AEAD on byte strings                                    */
+/* ------------------------------------------------------------------ */
+
+#define ASCON_128_IV 0x80400c0600000000ULL
+
+static bit64 load_be(const uint8_t *b, size_t n) {
+  bit64 v = 0;
+  for(size_t i = 0; i < n; i++) v |= (bit64)b[i] << (56 - 8 * i);
+  return v;
+}
+
+static void store_be(uint8_t *b, bit64 v, size_t n) {
+  for(size_t i = 0; i < n; i++) b[i] = v >> (56 - 8 * i);
+}
+
+/* 0x80 pad byte at position n of a rate block */
+#define PAD(n) (0x80ULL << (56 - 8 * (n)))
+
+static void ascon128_start(bit64 s[5], bit64 k[2], const uint8_t key[16],
+                           const uint8_t nonce[16],
+                           const uint8_t *ad, size_t ad_len) {
+  k[0] = load_be(key, 8);
+  k[1] = load_be(key + 8, 8);
+  s[0] = ASCON_128_IV;
+  s[1] = k[0];
+  s[2] = k[1];
+  s[3] = load_be(nonce, 8);
+  s[4] = load_be(nonce + 8, 8);
+  p_perm(s, 12);
+  s[3] ^= k[0];
+  s[4] ^= k[1];
+
+  if(ad_len) {
+    for(; ad_len >= 8; ad += 8, ad_len -= 8) {
+      s[0] ^= load_be(ad, 8);
+      p_perm(s, 6);
+    }
+    s[0] ^= load_be(ad, ad_len) ^ PAD(ad_len);
+    p_perm(s, 6);
+  }
+  s[4] ^= 1;
+}
+
+static void ascon128_tag(bit64 s[5], const bit64 k[2],
+                         uint8_t tag[ASCON_128_TAG_LEN]) {
+  s[1] ^= k[0];
+  s[2] ^= k[1];
+  p_perm(s, 12);
+  store_be(tag, s[3] ^ k[0], 8);
+  store_be(tag + 8, s[4] ^ k[1], 8);
+}
+
+void ascon128_encrypt(const uint8_t key[16], const uint8_t nonce[16],
+                      const uint8_t *ad, size_t ad_len,
+                      const uint8_t *pt, size_t len,
+                      uint8_t *ct, uint8_t *tag, size_t tag_len) {
+  bit64 s[5], k[2];
+  uint8_t t[ASCON_128_TAG_LEN];
+  RTPROF_BEGIN(RTPROF_ASCON_AEAD);
+  ascon128_start(s, k, key, nonce, ad, ad_len);
+
+  for(; len >= 8; pt += 8, ct += 8, len -= 8) {
+    s[0] ^= load_be(pt, 8);
+    store_be(ct, s[0], 8);
+    p_perm(s, 6);
+  }
+  s[0] ^= load_be(pt, len) ^ PAD(len);
+  store_be(ct, s[0], len);
+
+  ascon128_tag(s, k, t);
+  for(size_t i = 0; i < tag_len && i < ASCON_128_TAG_LEN; i++) tag[i] = t[i];
+  RTPROF_END(RTPROF_ASCON_AEAD);
+}
+
+int ascon128_decrypt(const uint8_t key[16], const uint8_t nonce[16],
+                     const uint8_t *ad, size_t ad_len,
+                     const uint8_t *ct, size_t len,
+                     uint8_t *pt, const uint8_t *tag, size_t tag_len) {
+  bit64 s[5], k[2], c;
+  uint8_t t[ASCON_128_TAG_LEN], diff = 0;
+  uint8_t *out = pt;
+  size_t total = len;
+
+  if(tag_len == 0 || tag_len > ASCON_128_TAG_LEN) {
+    return -1;
+  }
+  RTPROF_BEGIN(RTPROF_ASCON_AEAD);
+  ascon128_start(s, k, key, nonce, ad, ad_len);
+
+  for(; len >= 8; pt += 8, ct += 8, len -= 8) {
+    c = load_be(ct, 8);
+    store_be(pt, s[0] ^ c, 8);
+    s[0] = c;
+    p_perm(s, 6);
+  }
+  /* keep the key-stream bytes past the message, replace the rest */
+  c = load_be(ct, len);
+  store_be(pt, s[0] ^ c, len);
+  s[0] = (s[0] & (~0ULL >> (8 * len))) ^ c ^ PAD(len);
+
+  ascon128_tag(s, k, t);
+  for(size_t i = 0; i < tag_len; i++) diff |= t[i] ^ tag[i];
+  if(diff) {
+    for(size_t i = 0; i < total; i++) out[i] = 0;
+  }
+  RTPROF_END(RTPROF_ASCON_AEAD);
+  return diff ? -1 : 0;
+}
@@ -3,6 +3,7 @@
 #define ASCON_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* 64-bit word type */
 typedef uint64_t bit64;
@@ -46,7 +47,7 @@ void ascon_encrypt(bit64 state[5],
  *   - pt:       output buffer for plaintext
  *   - ct_len:   number of blocks
  *
- * Decrypts, same mode as encrypt.
+ * Decrypts, same mode as encrypt. ct and pt may be the same buffer.
  */
 void ascon_decrypt(bit64 state[5],
                    const bit64 *ct, bit64 *pt, int ct_len);
@@ -61,4 +62,105 @@ void ascon_decrypt(bit64 state[5],
  */
 void ascon_finalization(bit64 state[5], const bit64 key[2]);
 
+/* ------------------------------------------------------------------ */
+/*  ASCON-Hash, ASCON-XOF and keyed MAC (incremental)                 */
+/* ------------------------------------------------------------------ */
+
+#define ASCON_HASH_RATE  8   /* bytes absorbed per 12-round P */
+#define ASCON_HASH_LEN  32   /* ASCON-Hash digest size */
+#define ASCON_MAC_LEN   16   /* keyed MAC tag size */
+
+/**
+ * Sponge state for the hash/XOF/MAC functions. Only the 40-byte
+ * permutation state is kept, so input can be fed in any chunk size
+ * (e.g. one external-flash page at a time) without buffering it.
+ */
+typedef struct {
+  bit64   s[5];
+  uint8_t pos;        /* byte offset within the current rate block */
+  uint8_t squeezing;  /* set once padding has been applied */
+} ascon_hash_ctx;
+
+/**
+ * ascon_hash_init(ctx) / ascon_xof_init(ctx):
+ *
+ * Start an ASCON-Hash (256-bit digest) or ASCON-XOF (any length)
+ * computation, as specified in ASCON v1.2.
+ */
+void ascon_hash_init(ascon_hash_ctx *ctx);
+void ascon_xof_init(ascon_hash_ctx *ctx);
+
+/**
+ * ascon_hash_update(ctx, in, len):
+ *
+ * Absorb len bytes. May be called any number of times before the
+ * digest is read; also used to feed message data to the MAC.
+ */
+void ascon_hash_update(ascon_hash_ctx *ctx,
+                       const uint8_t *in, size_t len);
+
+/**
+ * ascon_hash_final(ctx, out):
+ *
+ * Pad and write the 32-byte ASCON-Hash digest.
+ */
+void ascon_hash_final(ascon_hash_ctx *ctx, uint8_t out[ASCON_HASH_LEN]);
+
+/**
+ * ascon_xof_squeeze(ctx, out, len):
+ *
+ * Pad on the first call, then write len output bytes. Repeated calls
+ * continue the output stream.
+ */
+void ascon_xof_squeeze(ascon_hash_ctx *ctx, uint8_t *out, size_t len);
+
+/**
+ * ascon_mac_init(ctx, key) / ascon_mac_final(ctx, tag):
+ *
+ * Keyed MAC: ASCON-XOF over key || message, truncated to 16 bytes.
+ * Feed the message with ascon_hash_update() in between.
+ */
+void ascon_mac_init(ascon_hash_ctx *ctx, const uint8_t key[16]);
+void ascon_mac_final(ascon_hash_ctx *ctx, uint8_t tag[ASCON_MAC_LEN]);
+
+/**
+ * ascon_mac_verify(ctx, tag):
+ *
+ * Finalize and compare against tag in constant time.
+ * Returns 0 on match, -1 otherwise.
+ */
+int ascon_mac_verify(ascon_hash_ctx *ctx, const uint8_t tag[ASCON_MAC_LEN]);
+
+/* ------------------------------------------------------------------ */
+/*  ASCON-128 AEAD on byte strings                                    */
+/* ------------------------------------------------------------------ */
+
+#define ASCON_128_NONCE_LEN 16
+#define ASCON_128_TAG_LEN   16
+
+/**
+ * ascon128_encrypt(key, nonce, ad, ad_len, pt, len, ct, tag):
+ *
+ * One-shot ASCON-128 (v1.2) with arbitrary byte lengths and the
+ * standard 10* padding, unlike the word-level calls above. ct may
+ * equal pt. Writes len bytes of ciphertext and the first tag_len
+ * (up to 16) bytes of the tag.
+ */
+void ascon128_encrypt(const uint8_t key[16], const uint8_t nonce[16],
+                      const uint8_t *ad, size_t ad_len,
+                      const uint8_t *pt, size_t len,
+                      uint8_t *ct, uint8_t *tag, size_t tag_len);
+
+/**
+ * ascon128_decrypt(key, nonce, ad, ad_len, ct, len, pt, tag):
+ *
+ * Inverse of ascon128_encrypt(). Checks the first tag_len (1..16)
+ * tag bytes; returns 0 if they match, -1 otherwise (pt is wiped).
+ * pt may equal ct.
+ */
+int ascon128_decrypt(const uint8_t key[16], const uint8_t nonce[16],
+                     const uint8_t *ad, size_t ad_len,
+                     const uint8_t *ct, size_t len,
+                     uint8_t *pt, const uint8_t *tag, size_t tag_len);
+
 #endif /* ASCON_H */
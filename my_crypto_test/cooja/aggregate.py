@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""
+aggregate.py
+Confidence intervals over rec1 records, and regression checks
+
+usage: aggregate.py [--json] [--baseline file] [-T percent] log...
+
+Collects the rec1 lines (see report/record.h) from any mix of Cooja
+testlogs, serial captures and native runs, and groups them by
+target, build, workload and payload. Every record is one sample, so
+rounds, motes and repeated runs all add up. Per group it prints the
+mean and the 95% confidence interval half-width (Student t) of:
+
+  us_per_iter      CPU time per iteration
+  cycles_per_iter  us_per_iter x nominal MCLK (empty for native)
+  uj_per_iter      modelled energy per iteration (CPU, LPM and radio,
+                   currents of parse_logs.py; empty for native)
+  aead_us_per_iter time inside the AEAD calls (my_crypto_net only)
+
+--json prints the same as JSON lines; save that as a baseline:
+
+  cooja/aggregate.py --json results/*.testlog > baseline.jsonl
+  ... change, rebuild, rerun ...
+  cooja/aggregate.py --baseline baseline.jsonl results/*.testlog
+
+With --baseline every group found in both is compared on energy and
+cycles (CPU time where there are no cycles). A metric has regressed if
+its mean grew by more than -T percent (default 5) and the change is
+significant: when both sides have at least three samples, by Welch's
+t-test on the difference of the means (two-sided, 95%, standard errors
+recovered from the logged intervals); with fewer samples on either
+side there is no usable variance estimate and the threshold alone
+decides. Improvements are judged the same way.
+Baseline groups absent from the new run (a workload that stopped
+logging, a build that failed) get one row marked MISSING. Both
+REGRESSED and MISSING make the exit status 1.
+"""
+
+import argparse
+import csv
+import json
+import math
+import re
+import sys
+
+import parse_logs
+
+REC_RE = re.compile(r"\brec1,(\S*)")
+REC_FIELDS = ["target", "build", "workload", "payload", "iter", "round",
+              "ticks_s", "cpu", "lpm", "tx", "rx", "aead"]
+
+KEY = ["target", "build", "workload", "payload"]
+METRICS = ["us_per_iter", "cycles_per_iter", "uj_per_iter",
+           "aead_us_per_iter"]
+
+# two-sided 95% Student t by degrees of freedom; larger df use the
+# entry for the next smaller tabulated df
+T95 = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+       2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+       2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+       2.048, 2.045, 2.042]
+T95_LARGE = [(120, 1.980), (60, 2.000), (40, 2.021), (30, 2.042)]
+
+
+def t95(df):
+    if df <= len(T95):
+        return T95[df - 1]
+    for d, t in T95_LARGE:
+        if df >= d:
+            return t
+    return T95[-1]
+
+
+def samples(path):
+    """Per-iteration metrics of every rec1 record in the file"""
+    out = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = REC_RE.search(line)
+            if not m:
+                continue
+            v = m.group(1).split(",")
+            if len(v) != len(REC_FIELDS):
+                continue
+            r = dict(zip(REC_FIELDS, v))
+            it = int(r["iter"])
+            second = int(r["ticks_s"])
+            if it == 0 or second == 0:
+                continue
+            cpu_s = int(r["cpu"]) / second / it
+            s = {k: r[k] for k in KEY}
+            s["us_per_iter"] = cpu_s * 1e6
+            hz = parse_logs.CPU_HZ.get(r["target"])
+            s["cycles_per_iter"] = cpu_s * hz if hz else None
+            cur = parse_logs.CURRENT_MA.get(r["target"])
+            s["uj_per_iter"] = parse_logs.SUPPLY_V * sum(
+                cur[k] * int(r[k]) for k in ("cpu", "lpm", "tx", "rx")) \
+                / second * 1000 / it if cur else None
+            # AEAD time is measured on the rtimer, which is the Energest
+            # clock on every platform we run
+            s["aead_us_per_iter"] = int(r["aead"]) / second * 1e6 / it \
+                if r["aead"] else None
+            out.append(s)
+    return out
+
+
+def aggregate(all_samples):
+    groups = {}
+    for s in all_samples:
+        groups.setdefault(tuple(s[k] for k in KEY), []).append(s)
+
+    out = []
+    for key, ss in sorted(groups.items()):
+        g = dict(zip(KEY, key))
+        g["n"] = len(ss)
+        for m in METRICS:
+            vals = [s[m] for s in ss if s[m] is not None]
+            if not vals:
+                g[m] = g[m + "_ci"] = None
+                continue
+            n = len(vals)
+            mean = sum(vals) / n
+            ci = None       # undefined for a single sample
+            if n > 1:
+                sd = math.sqrt(sum((x - mean) ** 2 for x in vals) / (n - 1))
+                ci = t95(n - 1) * sd / math.sqrt(n)
+            g[m] = mean
+            g[m + "_ci"] = ci
+        out.append(g)
+    return out
+
+
+def fmt(v):
+    return "" if v is None else "%.6g" % v
+
+
+def significant(b, g, m):
+    """Welch's t-test on metric m of groups b and g, see above"""
+    nb, ng = b.get("n", 0), g.get("n", 0)
+    if nb < 3 or ng < 3 or b[m + "_ci"] is None or g[m + "_ci"] is None:
+        return True
+    vb = (b[m + "_ci"] / t95(nb - 1)) ** 2
+    vg = (g[m + "_ci"] / t95(ng - 1)) ** 2
+    if vb + vg == 0:
+        return g[m] != b[m]
+    t = abs(g[m] - b[m]) / math.sqrt(vb + vg)
+    df = (vb + vg) ** 2 / (vb ** 2 / (nb - 1) + vg ** 2 / (ng - 1))
+    return t > t95(max(1, int(df)))
+
+
+def compare(base, new, threshold):
+    """One row per group and metric present on both sides, and one
+    MISSING row per baseline group absent from new"""
+    index = {tuple(b[k] for k in KEY): b for b in base}
+    seen = {tuple(g[k] for k in KEY) for g in new}
+    rows = []
+    for key, b in sorted(index.items()):
+        if key not in seen:
+            row = dict(zip(KEY, key))
+            row.update({"metric": "", "base": "", "base_ci": "", "new": "",
+                        "new_ci": "", "change_pct": "", "status": "MISSING"})
+            rows.append(row)
+    for g in new:
+        b = index.get(tuple(g[k] for k in KEY))
+        if not b:
+            continue
+        metrics = ["uj_per_iter"]
+        metrics.append("cycles_per_iter" if g.get("cycles_per_iter")
+                       is not None else "us_per_iter")
+        for m in metrics:
+            bm, nm = b.get(m), g.get(m)
+            if bm is None or nm is None or bm == 0:
+                continue
+            change = 100.0 * (nm - bm) / bm
+            status = "ok"
+            if abs(change) > threshold and significant(b, g, m):
+                status = "REGRESSED" if change > 0 else "improved"
+            row = {k: g[k] for k in KEY}
+            row.update({"metric": m, "base": fmt(bm),
+                        "base_ci": fmt(b[m + "_ci"]), "new": fmt(nm),
+                        "new_ci": fmt(g[m + "_ci"]),
+                        "change_pct": "%.2f" % change, "status": status})
+            rows.append(row)
+    return rows
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Aggregate rec1 records")
+    ap.add_argument("logs", nargs="+")
+    ap.add_argument("--json", action="store_true",
+                    help="JSON lines instead of CSV")
+    ap.add_argument("--baseline",
+                    help="JSON lines from an earlier --json run")
+    ap.add_argument("-T", "--threshold", type=float, default=5.0,
+                    help="regression threshold in percent (default 5)")
+    a = ap.parse_args()
+
+    ss = []
+    for path in a.logs:
+        ss += samples(path)
+    if not ss:
+        sys.exit("aggregate.py: no rec1 records found")
+    groups = aggregate(ss)
+
+    if a.baseline:
+        with open(a.baseline) as f:
+            base = [json.loads(line) for line in f if line.strip()]
+        rows = compare(base, groups, a.threshold)
+        cols = KEY + ["metric", "base", "base_ci", "new", "new_ci",
+                      "change_pct", "status"]
+        status = 1 if any(r["status"] in ("REGRESSED", "MISSING")
+                          for r in rows) else 0
+    else:
+        rows = groups
+        cols = KEY + ["n"]
+        for m in METRICS:
+            cols += [m, m + "_ci"]
+        status = 0
+
+    if a.json:
+        for r in rows:
+            sys.stdout.write(json.dumps({k: r[k] for k in cols}) + "\n")
+    else:
+        w = csv.DictWriter(sys.stdout, fieldnames=cols,
+                           extrasaction="ignore")
+        w.writeheader()
+        for r in rows:
+            w.writerow({k: fmt(v) if isinstance(v, float) or v is None
+                        else v for k, v in r.items()})
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    main()
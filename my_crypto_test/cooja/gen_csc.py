@@ -0,0 +1,309 @@
+#!/usr/bin/env python3
+"""
+gen_csc.py
+Generate the Cooja scenarios in this directory
+
+usage: gen_csc.py bench|net|profile [-t sky|z1] [-n nodes] [-d seconds]
+                  [-r rounds] [-s seed] [--app-dir dir] [--firmware file]
+                  [-m map] [--trace file]
+
+  bench  one mote running my_crypto_test; the run ends once `rounds`
+         full passes over the workloads have been logged
+  net    `nodes` motes (2-50) running my_crypto_net on a grid, node 1
+         (the RPL root and sink) in a corner so traffic is multi-hop;
+         the run ends after `seconds` of simulated time
+  profile  one mote running my_crypto_test under MSPSim's watchpoints:
+         every function in `map` (build/<target>/my_crypto_test.map) is
+         traced with its exact CPU cycle count to `file` for one full
+         round of the workloads; mspprof.py turns the trace into
+         profiles
+
+Both scenarios carry a ScriptRunner that copies every mote output line
+to COOJA.testlog as "<time us>\tID:<id>\t<line>" and ends the run with
+log.testOK() (or log.testFailed() if a bench run times out), so they
+can be run headless. The checked-in *.csc files are this script's
+output with the defaults (profile scenarios depend on the build and are
+generated by run.sh):
+
+  ./gen_csc.py bench -t sky > bench-sky.csc
+  ./gen_csc.py net   -t sky > net-sky.csc     (likewise for z1)
+"""
+
+import argparse
+import math
+import sys
+
+import mspmap
+
+SCHEMA_VERSION = "2022112801"
+
+# Mote type class and interfaces per platform
+PLATFORMS = {
+    "sky": ("org.contikios.cooja.mspmote.SkyMoteType", [
+        "org.contikios.cooja.interfaces.Position",
+        "org.contikios.cooja.interfaces.RimeAddress",
+        "org.contikios.cooja.interfaces.IPAddress",
+        "org.contikios.cooja.interfaces.Mote2MoteRelations",
+        "org.contikios.cooja.interfaces.MoteAttributes",
+        "org.contikios.cooja.mspmote.interfaces.MspClock",
+        "org.contikios.cooja.mspmote.interfaces.MspMoteID",
+        "org.contikios.cooja.mspmote.interfaces.SkyButton",
+        "org.contikios.cooja.mspmote.interfaces.SkyFlash",
+        "org.contikios.cooja.mspmote.interfaces.SkyCoffeeFilesystem",
+        "org.contikios.cooja.mspmote.interfaces.Msp802154Radio",
+        "org.contikios.cooja.mspmote.interfaces.MspSerial",
+        "org.contikios.cooja.mspmote.interfaces.SkyLED",
+        "org.contikios.cooja.mspmote.interfaces.MspDebugOutput",
+        "org.contikios.cooja.mspmote.interfaces.SkyTemperature",
+    ]),
+    "z1": ("org.contikios.cooja.mspmote.Z1MoteType", [
+        "org.contikios.cooja.interfaces.Position",
+        "org.contikios.cooja.interfaces.RimeAddress",
+        "org.contikios.cooja.interfaces.IPAddress",
+        "org.contikios.cooja.interfaces.Mote2MoteRelations",
+        "org.contikios.cooja.interfaces.MoteAttributes",
+        "org.contikios.cooja.mspmote.interfaces.MspClock",
+        "org.contikios.cooja.mspmote.interfaces.MspMoteID",
+        "org.contikios.cooja.mspmote.interfaces.Msp802154Radio",
+        "org.contikios.cooja.mspmote.interfaces.MspDefaultSerial",
+        "org.contikios.cooja.mspmote.interfaces.MspLED",
+        "org.contikios.cooja.mspmote.interfaces.MspDebugOutput",
+    ]),
+}
+
+# metres: side neighbours (40 m) are inside TX_RANGE, diagonal ones
+# (56.6 m) and the next but one (80 m) are not, so routes are multi-hop
+GRID_SPACING = 40.0
+TX_RANGE = 50.0
+INTERFERENCE_RANGE = 100.0
+
+# The scripts are JavaScript run by Cooja's ScriptRunner. TIMEOUT() must
+# be given a literal, hence the string substitution.
+BENCH_SCRIPT = """TIMEOUT(%(timeout_ms)d, log.testFailed());
+/* a round starts with the Energest header; the (rounds+1)th header
+ * means `rounds` complete rounds are in the log */
+var headers = 0;
+while(true) {
+  log.log(time + "\\tID:" + id + "\\t" + msg + "\\n");
+  if(msg.indexOf("----- Energest in last") >= 0) {
+    headers++;
+    if(headers > %(rounds)d) {
+      log.testOK();
+    }
+  }
+  YIELD();
+}
+"""
+
+# Watchpoints on every function entry log "C|I <addr> <cycles> <sp>";
+# each entry arms a watchpoint on its return address (read off the
+# stack: CALL pushes the return address, an interrupt pushes PC then
+# SR), which logs "R <cycles> <sp>" once SP shows the frame is gone.
+# Uses the MSPSim API shipped with Cooja (MSP430Core.addWatchPoint,
+# MemoryMonitor.Adapter, public cycles/reg/memory fields).
+# Start of the interrupt vector table: 16 vectors on sky's MSP430F1611,
+# 32 on z1's MSP430F2617
+VECTORS = {"sky": 0xffe0, "z1": 0xffc0}
+
+PROFILE_SCRIPT = """TIMEOUT(%(timeout_ms)d, log.testFailed());
+var ENTRIES = [%(entries)s];
+var out = new java.io.PrintWriter(new java.io.BufferedWriter(
+  new java.io.FileWriter("%(trace)s"), 1 << 16));
+var cpu = sim.getMoteWithID(1).getCPU();
+var Adapter = Java.type("se.sics.mspsim.core.MemoryMonitor$Adapter");
+var EXECUTE = Java.type("se.sics.mspsim.core.Memory$AccessType").EXECUTE;
+
+function word(a) { return cpu.memory[a] | (cpu.memory[a + 1] << 8); }
+
+/* handlers named in the vector table (reset excluded) */
+var isr = {};
+for(var v = %(vectors)s; v < 0xfffe; v += 2) { isr[word(v)] = true; }
+
+var frames = [];    /* {ret, entry, after}: SP at entry / after return */
+var armed = {};
+
+var onReturn = new (Java.extend(Adapter, {
+  notifyReadBefore: function(addr, mode, type) {
+    if(type != EXECUTE) { return; }
+    var sp = cpu.reg[1], n = 0;
+    while(frames.length > 0) {
+      var f = frames[frames.length - 1];
+      if(f.ret != addr || f.after != sp) { break; }
+      frames.pop();
+      n++;
+    }
+    if(n > 0) { out.println("R " + cpu.cycles + " " + sp); }
+  }
+}))();
+
+var onEntry = new (Java.extend(Adapter, {
+  notifyReadBefore: function(addr, mode, type) {
+    if(type != EXECUTE) { return; }
+    var sp = cpu.reg[1], irq = isr[addr] === true;
+    var ret = word(irq ? sp + 2 : sp);
+    /* frames entered at or above this SP are gone (tail calls) */
+    while(frames.length > 0 && frames[frames.length - 1].entry <= sp) {
+      frames.pop();
+    }
+    frames.push({ret: ret, entry: sp, after: sp + (irq ? 4 : 2)});
+    if(!armed[ret]) {
+      cpu.addWatchPoint(ret, onReturn);
+      armed[ret] = true;
+    }
+    out.println((irq ? "I " : "C ") + addr.toString(16) + " " + cpu.cycles
+                + " " + sp);
+  }
+}))();
+
+for(var i = 0; i < ENTRIES.length; i++) {
+  cpu.addWatchPoint(ENTRIES[i], onEntry);
+}
+
+/* one full round: stop at the second Energest header */
+var headers = 0;
+while(true) {
+  YIELD();
+  log.log(time + "\\tID:" + id + "\\t" + msg + "\\n");
+  if(msg.indexOf("----- Energest in last") >= 0 && ++headers > 1) {
+    out.close();
+    log.testOK();
+  }
+}
+"""
+
+NET_SCRIPT = """TIMEOUT(%(timeout_ms)d, log.testOK());
+while(true) {
+  log.log(time + "\\tID:" + id + "\\t" + msg + "\\n");
+  YIELD();
+}
+"""
+
+
+def motetype(platform, app, app_dir, motes, firmware=None):
+    cls, interfaces = PLATFORMS[platform]
+    out = []
+    out.append("    <motetype>")
+    out.append("      %s" % cls)
+    out.append("      <description>%s (%s)</description>" % (app, platform))
+    out.append("      <source>%s/%s.c</source>" % (app_dir, app))
+    if firmware:
+        # prebuilt with non-default flags: no build commands, or Cooja
+        # would rebuild it with the defaults
+        out.append("      <firmware>%s</firmware>" % firmware)
+    else:
+        out.append("      <commands>$(MAKE) -j$(CPUS) %s.%s TARGET=%s"
+                   "</commands>" % (app, platform, platform))
+        out.append("      <firmware>%s/build/%s/%s.%s</firmware>"
+                   % (app_dir, platform, app, platform))
+    for i in interfaces:
+        out.append("      <moteinterface>%s</moteinterface>" % i)
+    for mote_id, (x, y) in motes:
+        out.append("      <mote>")
+        out.append("        <interface_config>")
+        out.append("          org.contikios.cooja.interfaces.Position")
+        out.append('          <pos x="%.1f" y="%.1f" />' % (x, y))
+        out.append("        </interface_config>")
+        out.append("        <interface_config>")
+        out.append("          org.contikios.cooja.mspmote.interfaces.MspMoteID")
+        out.append("          <id>%d</id>" % mote_id)
+        out.append("        </interface_config>")
+        out.append("      </mote>")
+    out.append("    </motetype>")
+    return out
+
+
+def xml_escape(s):
+    return s.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;")
+
+
+def simconf(title, seed, mtype, script):
+    out = ['<?xml version="1.0" encoding="UTF-8"?>',
+           '<simconf version="%s">' % SCHEMA_VERSION,
+           "  <simulation>",
+           "    <title>%s</title>" % title,
+           "    <randomseed>%d</randomseed>" % seed,
+           "    <motedelay_us>1000000</motedelay_us>",
+           "    <radiomedium>",
+           "      org.contikios.cooja.radiomediums.UDGM",
+           "      <transmitting_range>%.1f</transmitting_range>" % TX_RANGE,
+           "      <interference_range>%.1f</interference_range>"
+           % INTERFERENCE_RANGE,
+           "      <success_ratio_tx>1.0</success_ratio_tx>",
+           "      <success_ratio_rx>1.0</success_ratio_rx>",
+           "    </radiomedium>",
+           "    <events>",
+           "      <logoutput>40000</logoutput>",
+           "    </events>"]
+    out += mtype
+    out += ["  </simulation>",
+            "  <plugin>",
+            "    org.contikios.cooja.plugins.ScriptRunner",
+            "    <plugin_config>",
+            "      <script>%s</script>" % xml_escape(script),
+            "      <active>true</active>",
+            "    </plugin_config>",
+            "  </plugin>",
+            "</simconf>"]
+    return "\n".join(out) + "\n"
+
+
+def grid(n):
+    cols = int(math.ceil(math.sqrt(n)))
+    return [(i + 1, ((i % cols) * GRID_SPACING, (i // cols) * GRID_SPACING))
+            for i in range(n)]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Generate Cooja scenarios")
+    ap.add_argument("scenario", choices=["bench", "net", "profile"])
+    ap.add_argument("-t", "--target", choices=sorted(PLATFORMS), default="sky")
+    ap.add_argument("-n", "--nodes", type=int, default=25,
+                    help="net: number of motes incl. the sink (default 25)")
+    ap.add_argument("-d", "--duration", type=int, default=1800,
+                    help="net: simulated seconds (default 1800)")
+    ap.add_argument("-r", "--rounds", type=int, default=3,
+                    help="bench: workload rounds to log (default 3)")
+    ap.add_argument("-s", "--seed", type=int, default=123456)
+    ap.add_argument("--app-dir", default="[CONFIG_DIR]/..",
+                    help="directory holding the firmware sources")
+    ap.add_argument("--firmware",
+                    help="prebuilt firmware to load as is")
+    ap.add_argument("-m", "--map",
+                    help="profile: linker map of the firmware")
+    ap.add_argument("--trace", default="profile.trace",
+                    help="profile: trace file to write")
+    a = ap.parse_args()
+
+    if a.scenario == "bench":
+        mtype = motetype(a.target, "my_crypto_test", a.app_dir,
+                         [(1, (0.0, 0.0))], a.firmware)
+        # generous guard: PRESENT through its hex API is slow on the MSP430
+        script = BENCH_SCRIPT % {"timeout_ms": 3600 * 1000 * a.rounds,
+                                 "rounds": a.rounds}
+        title = "my_crypto_test single-node benchmark (%s)" % a.target
+    elif a.scenario == "profile":
+        if not a.map:
+            sys.exit("gen_csc.py: profile needs --map")
+        # main is entered by falling through from the C runtime, not CALL
+        entries = ["0x%04x" % fn.addr for fn in mspmap.load(a.map)
+                   if fn.name != "main"]
+        mtype = motetype(a.target, "my_crypto_test", a.app_dir,
+                         [(1, (0.0, 0.0))], a.firmware)
+        script = PROFILE_SCRIPT % {"timeout_ms": 3600 * 1000,
+                                   "entries": ", ".join(entries),
+                                   "vectors": "0x%04x" % VECTORS[a.target],
+                                   "trace": a.trace.replace("\\", "/")}
+        title = "my_crypto_test MSPSim profile (%s)" % a.target
+    else:
+        if not 2 <= a.nodes <= 50:
+            sys.exit("gen_csc.py: --nodes must be 2..50")
+        mtype = motetype(a.target, "my_crypto_net", a.app_dir, grid(a.nodes),
+                         a.firmware)
+        script = NET_SCRIPT % {"timeout_ms": a.duration * 1000}
+        title = "my_crypto_net %d-node network (%s)" % (a.nodes, a.target)
+
+    sys.stdout.write(simconf(title, a.seed, mtype, script))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+"""
+mspmap.py
+Function table from a GNU ld map file (build/<target>/my_crypto_test.map)
+
+The msp430 builds use -ffunction-sections, so most functions, static
+ones included, show up as their own ".text.<name>" input section with
+address and size. Symbols inside plain ".text" sections (libc, libgcc,
+assembly) and main (in ".init9") are listed by address only and run
+to the next symbol.
+
+Used by gen_csc.py (entry addresses to watch) and mspprof.py (names).
+"""
+
+import re
+
+SECTION_RE = re.compile(r"^ (\.text[\w.$]*|\.init9)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)"
+                        r"\s+(\S+))?\s*$")
+CONT_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)\s*$")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+([A-Za-z_.$][\w.$]*)\s*$")
+OUTPUT_RE = re.compile(r"^(\S+)")
+
+
+class Function(object):
+    def __init__(self, name, addr, size, obj):
+        self.name = name
+        self.addr = addr
+        self.size = size
+        self.obj = obj
+
+    def __repr__(self):
+        return "%s@0x%04x+%d" % (self.name, self.addr, self.size)
+
+
+def load(path):
+    """Functions in the .text output section, sorted by address"""
+    sections = []     # (name, addr, size, obj)
+    symbols = []      # (addr, name)
+    in_map = in_text = False
+    pending = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+            m = OUTPUT_RE.match(line)
+            if m and not line.startswith(" "):
+                in_text = m.group(1) == ".text"
+                pending = None
+                continue
+            if not in_text:
+                continue
+
+            if pending:
+                m = CONT_RE.match(line)
+                if m:
+                    sections.append((pending, int(m.group(1), 16),
+                                     int(m.group(2), 16), m.group(3)))
+                pending = None
+                continue
+            m = SECTION_RE.match(line)
+            if m:
+                if m.group(2) is None:
+                    pending = m.group(1)     # address on the next line
+                else:
+                    sections.append((m.group(1), int(m.group(2), 16),
+                                     int(m.group(3), 16), m.group(4)))
+                continue
+            m = SYMBOL_RE.match(line)
+            if m and not m.group(2).startswith("."):
+                symbols.append((int(m.group(1), 16), m.group(2)))
+
+    funcs = {}
+    symbols.sort()
+    first = {}
+    for a, n in symbols:
+        first.setdefault(a, n)
+    for sec, addr, size, obj in sections:
+        if size == 0:
+            continue
+        obj = obj.split("/")[-1]
+        if sec.startswith(".text."):
+            # the global symbol if there is one (".text.libgcc" holds
+            # __mulsi3), else the section suffix (static functions)
+            name = first.get(addr, sec[len(".text."):])
+            if addr not in funcs:
+                funcs[addr] = Function(name, addr, size, obj)
+            continue
+        # plain .text: split at the symbols inside it
+        inside = [(a, n) for a, n in symbols if addr <= a < addr + size]
+        for i, (a, n) in enumerate(inside):
+            end = inside[i + 1][0] if i + 1 < len(inside) else addr + size
+            if a not in funcs and end > a:
+                funcs[a] = Function(n, a, end - a, obj)
+
+    # static functions with the same name in several files
+    seen = {}
+    for fn in funcs.values():
+        seen.setdefault(fn.name, []).append(fn)
+    for name, fns in seen.items():
+        if len(fns) > 1:
+            for fn in fns:
+                fn.name = "%s (%s)" % (name, fn.obj)
+
+    return sorted(funcs.values(), key=lambda fn: fn.addr)
+
+
+def by_address(funcs):
+    return {fn.addr: fn for fn in funcs}
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+mspprof.py
+Flat profile and call graph from an MSPSim call trace
+
+usage: mspprof.py -m map [-r regex] [-n top] [-D depth] [--csv] trace
+
+The trace is written by the "profile" scenario of gen_csc.py, one event
+per line, with MSPSim's CPU cycle counter and the stack pointer:
+
+  C <entry addr> <cycles> <sp>     function entered by CALL
+  I <entry addr> <cycles> <sp>     interrupt handler entered
+  R <cycles> <sp>                  innermost frame returned
+
+Cycles are exact: a function's inclusive count runs from the fetch of
+its first instruction to the fetch of the instruction after its CALL,
+so the CALL belongs to the caller and the RET to the callee.
+
+Every outermost activation of a function matching -r (default ^run_,
+the workloads of my_crypto_test.c) is a root; a flat profile and a
+call tree (aggregated by call path) are printed per root name.
+Interrupt handlers are left out of both, and their cycles are taken
+out of every frame they interrupted; the count and cost are reported
+per root.
+"""
+
+import argparse
+import csv
+import re
+import sys
+
+import mspmap
+
+
+class Frame(object):
+    __slots__ = ("name", "start", "sp", "isr", "in_isr", "root", "path",
+                 "children", "irq")
+
+    def __init__(self, name, start, sp, isr, in_isr, root, path):
+        self.name = name
+        self.start = start
+        self.sp = sp              # SP at entry
+        self.isr = isr
+        self.in_isr = in_isr      # an interrupt handler or called from one
+        self.root = root
+        self.path = path
+        self.children = 0         # net cycles of direct callees
+        self.irq = 0              # interrupt cycles inside this frame
+
+
+class Stats(object):
+    __slots__ = ("calls", "self_c", "incl")
+
+    def __init__(self):
+        self.calls = self.self_c = self.incl = 0
+
+
+class Profile(object):
+    def __init__(self, funcs, root_re):
+        self.funcs = mspmap.by_address(funcs)
+        self.root_re = re.compile(root_re)
+        self.stack = []
+        self.flat = {}            # root -> name -> Stats
+        self.tree = {}            # root -> path -> Stats
+        self.irqs = {}            # root -> [count, cycles]
+        self.unknown = 0
+
+    def name(self, addr):
+        fn = self.funcs.get(addr)
+        if fn:
+            return fn.name
+        self.unknown += 1
+        return "0x%04x" % addr
+
+    def enter(self, addr, t, sp, isr):
+        # frames whose entry SP is at or above this one have exited
+        # without a traced return (longjmp, missed watchpoint)
+        while self.stack and self.stack[-1].sp <= sp:
+            self.leave(t)
+        name = self.name(addr)
+        top = self.stack[-1] if self.stack else None
+        in_isr = isr or (top is not None and top.in_isr)
+        if in_isr:
+            root, path = (top.root if top else None), ()
+        elif top is not None and top.root is not None:
+            root, path = top.root, top.path + (name,)
+        elif self.root_re.search(name):
+            root, path = name, (name,)
+        else:
+            root, path = None, ()
+        self.stack.append(Frame(name, t, sp, isr, in_isr, root, path))
+
+    def leave(self, t):
+        f = self.stack.pop()
+        raw = t - f.start
+        parent = self.stack[-1] if self.stack else None
+
+        if f.isr:
+            if f.root is not None:
+                irq = self.irqs.setdefault(f.root, [0, 0])
+                irq[0] += 1
+                irq[1] += raw
+            if parent is not None:
+                parent.irq += raw
+            return
+        if f.in_isr:
+            return
+
+        net = raw - f.irq
+        if parent is not None:
+            parent.children += net
+            parent.irq += f.irq
+        if f.root is None:
+            return
+        fs = self.flat.setdefault(f.root, {}).setdefault(f.name, Stats())
+        ts = self.tree.setdefault(f.root, {}).setdefault(f.path, Stats())
+        for s in (fs, ts):
+            s.calls += 1
+            s.self_c += net - f.children
+        ts.incl += net
+        # recursion: flat inclusive time counts the outermost call only
+        if all(p.name != f.name for p in self.stack):
+            fs.incl += net
+
+    def ret(self, t, sp):
+        # pop to the frame this return belongs to
+        while self.stack:
+            f = self.stack[-1]
+            self.leave(t)
+            if f.sp + (4 if f.isr else 2) >= sp:
+                break
+
+    def run(self, lines):
+        for line in lines:
+            p = line.split()
+            if not p:
+                continue
+            if p[0] in ("C", "I") and len(p) == 4:
+                self.enter(int(p[1], 16), int(p[2]), int(p[3]), p[0] == "I")
+            elif p[0] == "R" and len(p) == 3:
+                self.ret(int(p[1]), int(p[2]))
+
+
+def report(prof, top, depth, out):
+    for root in sorted(prof.flat):
+        flat = prof.flat[root]
+        tree = prof.tree[root]
+        rs = tree[(root,)]
+        total = rs.incl or 1
+        irq = prof.irqs.get(root, [0, 0])
+        out.write("%s: %d calls, %d cycles (%.1f per call)"
+                  % (root, rs.calls, rs.incl, rs.incl / max(rs.calls, 1)))
+        out.write(", %d interrupts excluded (%d cycles)\n\n" % tuple(irq))
+
+        out.write("  Flat profile\n")
+        out.write("  %7s %13s %9s %11s %11s  %s\n"
+                  % ("self %", "self cycles", "calls", "self/call",
+                     "incl/call", "function"))
+        rows = sorted(flat.items(), key=lambda kv: -kv[1].self_c)
+        for name, s in rows[:top] if top else rows:
+            out.write("  %6.2f%% %13d %9d %11.1f %11.1f  %s\n"
+                      % (100.0 * s.self_c / total, s.self_c, s.calls,
+                         s.self_c / s.calls, s.incl / s.calls, name))
+
+        out.write("\n  Call graph (inclusive)\n")
+        out.write("  %7s %13s %9s  %s\n" % ("incl %", "cycles", "calls",
+                                            "function"))
+
+        def walk(path, level):
+            s = tree[path]
+            out.write("  %6.2f%% %13d %9d  %s%s\n"
+                      % (100.0 * s.incl / total, s.incl, s.calls,
+                         "  " * level, path[-1]))
+            if depth and level + 1 >= depth:
+                return
+            kids = [p for p in tree
+                    if len(p) == len(path) + 1 and p[:-1] == path]
+            for k in sorted(kids, key=lambda p: -tree[p].incl):
+                walk(k, level + 1)
+
+        walk((root,), 0)
+        out.write("\n")
+
+
+def write_csv(prof, out):
+    w = csv.writer(out)
+    w.writerow(["root", "function", "calls", "self_cycles", "incl_cycles"])
+    for root in sorted(prof.flat):
+        for name, s in sorted(prof.flat[root].items(),
+                              key=lambda kv: -kv[1].self_c):
+            w.writerow([root, name, s.calls, s.self_c, s.incl])
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Profile an MSPSim call trace")
+    ap.add_argument("trace")
+    ap.add_argument("-m", "--map", required=True,
+                    help="linker map of the traced firmware")
+    ap.add_argument("-r", "--root", default="^run_",
+                    help="regex of functions to profile under")
+    ap.add_argument("-n", "--top", type=int, default=25,
+                    help="flat profile rows per root (0: all)")
+    ap.add_argument("-D", "--depth", type=int, default=0,
+                    help="call graph depth (0: unlimited)")
+    ap.add_argument("--csv", action="store_true",
+                    help="flat profiles as CSV instead of the report")
+    a = ap.parse_args()
+
+    prof = Profile(mspmap.load(a.map), a.root)
+    with open(a.trace) as f:
+        prof.run(f)
+    # frames still open at the end of the trace are incomplete and are
+    # not counted
+
+    if a.csv:
+        write_csv(prof, sys.stdout)
+    else:
+        report(prof, a.top, a.depth, sys.stdout)
+    if prof.unknown:
+        sys.stderr.write("mspprof: %d entries at addresses not in the map; "
+                         "is it the map of the traced firmware?\n"
+                         % prof.unknown)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/bin/sh
+#---------------------------------------------------------------------------#
+#  examples/my_crypto_test/cooja/opt_matrix.sh
+#  Build and benchmark my_crypto_test over a matrix of compiler flags
+#---------------------------------------------------------------------------#
+#
+# usage: cooja/opt_matrix.sh [-t "sky z1 native"] [-O "s 2 3"] [-l "0 1"]
+#                            [-u "0 1"] [-m "430 430x"] [-r rounds]
+#                            [-d seconds] [-o outdir]
+#
+# Every combination of optimization level (-O), LTO (-l), loop
+# unrolling (-u) and, on z1 only, instruction set (-m; sky's
+# MSP430F1611 has no MSP430X) is built into its own BUILD_DIR, so the
+# checked-in build/ is left alone, and then benchmarked: sky and z1 for
+# `rounds` rounds of the bench scenario in Cooja, native by running
+# the firmware for `seconds`. Each configuration leaves
+#
+#   <outdir>/<target>/<config>/config          make knobs used
+#   <outdir>/<target>/<config>/size.txt        size(1) of the firmware
+#   <outdir>/<target>/<config>/bench.testlog   benchmark log
+#
+# which cooja/opt_table.py turns into one table:
+#
+#   cooja/opt_matrix.sh -t "z1 native"
+#   cooja/opt_table.py results/opt > opt.csv
+#   cooja/opt_table.py --best results/opt
+#
+# A configuration that does not build (LTO is not supported by every
+# msp430 toolchain) leaves no testlog and is skipped by opt_table.py.
+# Native builds use nullnet so they run without a tun device.
+# MSP430_SIZE (default msp430-size) and SIZE (default size) name the
+# size tools; CONTIKI and COOJA are as for run.sh.
+
+set -e
+
+APP_DIR=$(cd "$(dirname "$0")/.." && pwd)
+CONTIKI=${CONTIKI:-$APP_DIR/../..}
+COOJA=${COOJA:-}
+MSP430_SIZE=${MSP430_SIZE:-msp430-size}
+SIZE=${SIZE:-size}
+
+TARGETS="sky z1 native"
+OPTS="s 2 3"
+LTOS="0 1"
+UNROLLS="0 1"
+MCPUS="430 430x"
+ROUNDS=3
+SECONDS_NATIVE=10
+OUT=$APP_DIR/results/opt
+
+while getopts "t:O:l:u:m:r:d:o:" opt; do
+  case $opt in
+    t) TARGETS=$OPTARG ;;
+    O) OPTS=$OPTARG ;;
+    l) LTOS=$OPTARG ;;
+    u) UNROLLS=$OPTARG ;;
+    m) MCPUS=$OPTARG ;;
+    r) ROUNDS=$OPTARG ;;
+    d) SECONDS_NATIVE=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) sed -n 's/^# usage: /usage: /p' "$0" >&2; exit 2 ;;
+  esac
+done
+
+mkdir -p "$OUT"
+OUT=$(cd "$OUT" && pwd)
+
+# cooja logdir csc
+cooja() {
+  if [ -n "$COOJA" ]; then
+    # shellcheck disable=SC2086
+    $COOJA "--logdir=$1" "$2"
+  else
+    "$CONTIKI/tools/cooja/gradlew" --no-watch-fs --quiet \
+      -p "$CONTIKI/tools/cooja" run \
+      --args="--contiki=$CONTIKI --no-gui --logdir=$1 $2"
+  fi
+}
+
+# run_one target opt lto unroll mcpu ("-" for the platform default)
+run_one() {
+  target=$1 o=$2 l=$3 u=$4 m=$5
+  name=O$o-lto$l-unroll$u
+  knobs="OPT=$o LTO=$l UNROLL=$u"
+  if [ "$m" != - ]; then
+    name=$name-$m
+    knobs="$knobs MCPU=$m"
+  fi
+  if [ "$target" = native ]; then
+    knobs="$knobs MAKE_NET=MAKE_NET_NULLNET"
+  fi
+  work=$OUT/$target/$name
+  fw=$work/build/$target/my_crypto_test.$target
+
+  echo "== $target $name"
+  rm -rf "$work"
+  mkdir -p "$work"
+  echo "target=$target opt=$o lto=$l unroll=$u mcpu=$m" > "$work/config"
+  # shellcheck disable=SC2086
+  if ! make -C "$APP_DIR" -s TARGET="$target" BUILD_DIR="$work/build" \
+       $knobs "my_crypto_test.$target" > "$work/build.out" 2>&1; then
+    echo "   build failed, see $work/build.out" >&2
+    return 0
+  fi
+
+  if [ "$target" = native ]; then
+    "$SIZE" "$fw" > "$work/size.txt"
+    # runs until killed; timeout's exit status is expected
+    timeout "$SECONDS_NATIVE" "$fw" > "$work/bench.testlog" 2>&1 || true
+    return 0
+  fi
+
+  "$MSP430_SIZE" "$fw" > "$work/size.txt"
+  "$APP_DIR/cooja/gen_csc.py" bench -t "$target" -r "$ROUNDS" \
+      --app-dir "$APP_DIR" --firmware "$fw" > "$work/bench.csc"
+  if ! cooja "$work" "$work/bench.csc" > "$work/cooja.out" 2>&1; then
+    echo "   failed, see $work/cooja.out" >&2
+  fi
+  if [ -f "$work/COOJA.testlog" ]; then
+    mv "$work/COOJA.testlog" "$work/bench.testlog"
+  fi
+}
+
+for target in $TARGETS; do
+  case $target in
+    z1) cpus=$MCPUS ;;
+    *)  cpus=- ;;
+  esac
+  for o in $OPTS; do
+    for l in $LTOS; do
+      for u in $UNROLLS; do
+        for m in $cpus; do
+          run_one "$target" "$o" "$l" "$u" "$m"
+        done
+      done
+    done
+  done
+done
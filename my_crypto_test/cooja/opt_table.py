@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+opt_table.py
+One table of time, cycles, energy, flash and RAM per build configuration
+
+usage: opt_table.py [--best] [--baseline config] dir
+
+Reads the tree left by opt_matrix.sh (<dir>/<target>/<config>/ with
+config, size.txt and bench.testlog) and prints CSV, one row per
+target, configuration and workload, averaged over all logged rounds:
+
+  us_per_iter      CPU time per iteration (Energest)
+  cycles_per_iter  us_per_iter x the nominal MCLK of the platform
+                   (parse_logs.CPU_HZ; empty for native)
+  uj_per_iter      modelled energy per iteration (parse_logs.py)
+  flash, ram       text + data and data + bss of the firmware
+
+--best prints, per target and workload, the configuration with the
+lowest energy (CPU time on native) and its gain over --baseline
+(default Os-lto0-unroll0, i.e. -Os; on z1 its first -m variant).
+"""
+
+import argparse
+import csv
+import os
+import sys
+
+import parse_logs
+
+COLUMNS = ["target", "config", "opt", "lto", "unroll", "mcpu", "workload",
+           "iterations", "reports", "us_per_iter", "cycles_per_iter",
+           "uj_per_iter", "flash", "ram"]
+
+
+def read_config(path):
+    with open(path) as f:
+        return dict(kv.split("=", 1) for kv in f.read().split())
+
+
+def read_size(path):
+    """(flash, ram) from Berkeley-format size(1) output"""
+    with open(path) as f:
+        lines = f.read().splitlines()
+    if len(lines) < 2:
+        return "", ""
+    text, data, bss = (int(v) for v in lines[1].split()[:3])
+    return text + data, data + bss
+
+
+def load(top):
+    rows = []
+    for target in sorted(os.listdir(top)):
+        tdir = os.path.join(top, target)
+        if not os.path.isdir(tdir):
+            continue
+        for name in sorted(os.listdir(tdir)):
+            cdir = os.path.join(tdir, name)
+            log = os.path.join(cdir, "bench.testlog")
+            if not os.path.isfile(log):
+                continue
+            conf = read_config(os.path.join(cdir, "config"))
+            flash, ram = read_size(os.path.join(cdir, "size.txt"))
+            rows += summarize(target, name, conf, flash, ram,
+                              parse_logs.parse(log, target))
+    return rows
+
+
+def summarize(target, name, conf, flash, ram, logged):
+    groups = {}
+    for r in logged:
+        if r["iterations"]:
+            groups.setdefault(r["workload"], []).append(r)
+
+    out = []
+    for workload, rs in groups.items():
+        iters = sum(r["iterations"] for r in rs)
+        us = sum(float(r["cpu_s"]) for r in rs) * 1e6 / iters
+        mj = [float(r["energy_mj"]) for r in rs if r["energy_mj"] != ""]
+        hz = parse_logs.CPU_HZ.get(target)
+        out.append({
+            "target": target, "config": name,
+            "opt": conf.get("opt", ""), "lto": conf.get("lto", ""),
+            "unroll": conf.get("unroll", ""),
+            "mcpu": conf.get("mcpu", "-"),
+            "workload": workload,
+            "iterations": iters, "reports": len(rs),
+            "us_per_iter": "%.2f" % us,
+            "cycles_per_iter": "%.0f" % (us * hz / 1e6) if hz else "",
+            "uj_per_iter": "%.3f" % (sum(mj) * 1000 / iters)
+            if len(mj) == len(rs) else "",
+            "flash": flash, "ram": ram})
+    return out
+
+
+def cost(row):
+    return float(row["uj_per_iter"] or row["us_per_iter"])
+
+
+def best(rows, baseline):
+    groups = {}
+    for r in rows:
+        groups.setdefault((r["target"], r["workload"]), []).append(r)
+
+    out = []
+    for (target, workload), rs in sorted(groups.items()):
+        win = min(rs, key=cost)
+        # the baseline without an -m suffix, or its first variant on z1
+        base = [r for r in rs if r["config"] == baseline] or \
+               [r for r in rs if r["config"].startswith(baseline + "-")]
+        gain = ""
+        if base:
+            b = cost(base[0])
+            gain = "%.1f" % (100.0 * (b - cost(win)) / b) if b else ""
+        out.append({"target": target, "workload": workload,
+                    "config": win["config"],
+                    "metric": "uj_per_iter" if win["uj_per_iter"]
+                    else "us_per_iter",
+                    "value": "%g" % cost(win),
+                    "gain_pct": gain,
+                    "flash": win["flash"], "ram": win["ram"]})
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Compiler matrix table")
+    ap.add_argument("dir", help="output directory of opt_matrix.sh")
+    ap.add_argument("--best", action="store_true",
+                    help="best configuration per target and workload")
+    ap.add_argument("--baseline", default="Os-lto0-unroll0",
+                    help="configuration --best compares against")
+    a = ap.parse_args()
+
+    rows = load(a.dir)
+    if not rows:
+        sys.exit("opt_table.py: no benchmark logs under %s" % a.dir)
+
+    if a.best:
+        rows = best(rows, a.baseline)
+        cols = ["target", "workload", "config", "metric", "value",
+                "gain_pct", "flash", "ram"]
+    else:
+        cols = COLUMNS
+
+    w = csv.DictWriter(sys.stdout, fieldnames=cols, extrasaction="ignore")
+    w.writeheader()
+    w.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+parse_logs.py
+Turn Cooja mote logs into CSV, one row per workload per report
+
+usage: parse_logs.py [-t sky|z1] [--summary] log...
+
+Reads COOJA.testlog files written by the scenarios in this directory
+("<time us>\tID:<id>\t<line>") or plain serial captures of a single
+mote, and picks out the Energest blocks logged by my_crypto_test and
+my_crypto_net:
+
+  [INFO: CryptoTest] ----- Energest in last 1s -----
+  [INFO: CryptoTest]  Ticks/s   : 32768
+  [INFO: CryptoTest]  Workload  : aes-ccm* x1000
+  [INFO: CryptoTest]  Bytes     : 32000
+  [INFO: CryptoTest]  CPU ticks : ...            (LPM, TX, RX, AEAD)
+
+Scenario and platform come from file names of the form
+<scenario>-<platform>-<cipher>-<payload>.testlog as left by run.sh;
+-t sets the platform for other files. The cipher is the
+workload's prefix ("aes" for "aes-ccm*") and the payload is the bytes
+handled per iteration.
+
+Ticks are converted with the logged Ticks/s (ENERGEST_SECOND if the
+log has none, as for my_crypto_net). Energy is ticks / Ticks/s x
+current x supply voltage, with typical datasheet currents per platform
+(see CURRENT_MA); treat it as a model, not a measurement. --summary
+averages each workload over all reports and motes instead of printing
+raw rows.
+"""
+
+import argparse
+import csv
+import os
+import re
+import sys
+
+ENERGEST_SECOND = 32768     # rtimer ticks on sky and z1 (MSP430)
+SUPPLY_V = 3.0
+
+# mA drawn in each Energest state: MCU active, MCU in LPM, CC2420 TX at
+# 0 dBm, CC2420 RX/listen
+CURRENT_MA = {
+    "sky": {"cpu": 1.8, "lpm": 0.0545, "tx": 17.4, "rx": 18.8},
+    "z1":  {"cpu": 4.1, "lpm": 0.0005, "tx": 17.4, "rx": 18.8},
+}
+
+# MCLK set up by Contiki-NG (F_CPU): DCO at 3.9 MHz on sky, 8 MHz on z1
+CPU_HZ = {"sky": 3900000, "z1": 8000000}
+
+LINE_RE = re.compile(r"^(\d+)\s+ID:(\d+)\s+(.*)$")
+LOG_RE = re.compile(r"\[\s*\w+\s*:\s*(Crypto\w+)\s*\]\s?(.*)$")
+HEADER_RE = re.compile(r"----- Energest in last (\d+)s -----")
+TICKS_RE = re.compile(r"^\s*Ticks/s\s*:\s*(\d+)")
+WORKLOAD_RE = re.compile(r"^\s*Workload\s*:\s*(\S+) x(\d+)")
+FIELD_RE = re.compile(r"^\s*(Bytes|CPU ticks|LPM ticks|TX ticks|RX ticks|"
+                      r"AEAD ticks)\s*:\s*(\d+)")
+NAME_RE = re.compile(r"^(\w+)-(\w+)-(\w+)-(\d+)$")
+
+FIELDS = {"Bytes": "bytes", "CPU ticks": "cpu_ticks",
+          "LPM ticks": "lpm_ticks", "TX ticks": "tx_ticks",
+          "RX ticks": "rx_ticks", "AEAD ticks": "aead_ticks"}
+
+COLUMNS = ["scenario", "platform", "cipher", "payload", "workload",
+           "mote", "round", "time_s", "iterations", "bytes",
+           "cpu_ticks", "lpm_ticks", "tx_ticks", "rx_ticks", "aead_ticks",
+           "cpu_s", "energy_mj", "uj_per_byte"]
+
+
+def file_meta(path, platform):
+    base = os.path.basename(path)
+    stem = base.split(".")[0]
+    m = NAME_RE.match(stem)
+    if m:
+        return {"scenario": m.group(1), "platform": m.group(2)}
+    return {"scenario": "", "platform": platform or ""}
+
+
+def finish(row, meta):
+    """Fill the derived columns of a complete row"""
+    row.update(meta)
+    it = row["iterations"]
+    second = row.pop("ticks_per_s")
+    row["cipher"] = row["workload"].split("-")[0]
+    row["payload"] = row["bytes"] // it if it else ""
+    row["cpu_s"] = "%.6f" % (row["cpu_ticks"] / second)
+    cur = CURRENT_MA.get(meta["platform"])
+    if cur:
+        mj = SUPPLY_V * sum(cur[k] * row[k + "_ticks"]
+                            for k in ("cpu", "lpm", "tx", "rx")) / second
+        row["energy_mj"] = "%.6f" % mj
+        row["uj_per_byte"] = "%.4f" % (mj * 1000 / row["bytes"]) \
+            if row["bytes"] else ""
+    else:
+        row["energy_mj"] = row["uj_per_byte"] = ""
+    return row
+
+
+def parse(path, platform):
+    meta = file_meta(path, platform)
+    rounds = {}     # mote -> number of headers seen
+    ticks = {}      # mote -> logged Ticks/s
+    cur = {}        # mote -> row being filled
+    rows = []
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            m = LINE_RE.match(line)
+            if m:
+                t_us, mote, msg = int(m.group(1)), int(m.group(2)), m.group(3)
+            else:
+                t_us, mote, msg = 0, 1, line
+            m = LOG_RE.search(msg)
+            if not m:
+                continue
+            text = m.group(2)
+
+            if HEADER_RE.search(text):
+                rounds[mote] = rounds.get(mote, 0) + 1
+                continue
+            m = TICKS_RE.match(text)
+            if m:
+                ticks[mote] = int(m.group(1))
+                continue
+            m = WORKLOAD_RE.match(text)
+            if m:
+                if mote in cur:
+                    rows.append(finish(cur.pop(mote), meta))
+                cur[mote] = {"workload": m.group(1),
+                             "iterations": int(m.group(2)),
+                             "mote": mote, "round": rounds.get(mote, 0),
+                             "ticks_per_s": ticks.get(mote, ENERGEST_SECOND),
+                             "time_s": "%.3f" % (t_us / 1e6),
+                             "bytes": 0, "cpu_ticks": 0, "lpm_ticks": 0,
+                             "tx_ticks": 0, "rx_ticks": 0, "aead_ticks": ""}
+                continue
+            m = FIELD_RE.match(text)
+            if m and mote in cur:
+                cur[mote][FIELDS[m.group(1)]] = int(m.group(2))
+
+    for mote in sorted(cur):
+        rows.append(finish(cur[mote], meta))
+    return rows
+
+
+def summarize(rows):
+    groups = {}
+    for r in rows:
+        key = (r["scenario"], r["platform"], r["cipher"], r["payload"],
+               r["workload"])
+        groups.setdefault(key, []).append(r)
+
+    out = []
+    for key, rs in sorted(groups.items(), key=lambda kv: str(kv[0])):
+        n = len(rs)
+        s = {"scenario": key[0], "platform": key[1], "cipher": key[2],
+             "payload": key[3], "workload": key[4], "reports": n,
+             "motes": len({r["mote"] for r in rs})}
+        for col in ("iterations", "bytes", "cpu_ticks", "lpm_ticks",
+                    "tx_ticks", "rx_ticks"):
+            s[col] = "%.1f" % (sum(r[col] for r in rs) / n)
+        aead = [r["aead_ticks"] for r in rs if r["aead_ticks"] != ""]
+        s["aead_ticks"] = "%.1f" % (sum(aead) / len(aead)) if aead else ""
+        mj = [float(r["energy_mj"]) for r in rs if r["energy_mj"] != ""]
+        s["energy_mj"] = "%.6f" % (sum(mj) / len(mj)) if mj else ""
+        total_bytes = sum(r["bytes"] for r in rs)
+        s["uj_per_byte"] = "%.4f" % (sum(mj) * 1000 / total_bytes) \
+            if mj and total_bytes else ""
+        out.append(s)
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Cooja mote logs to CSV")
+    ap.add_argument("logs", nargs="+")
+    ap.add_argument("-t", "--target", choices=sorted(CURRENT_MA),
+                    help="platform of logs whose name does not say")
+    ap.add_argument("--summary", action="store_true",
+                    help="one averaged row per workload")
+    a = ap.parse_args()
+
+    rows = []
+    for path in a.logs:
+        rows += parse(path, a.target)
+
+    if a.summary:
+        rows = summarize(rows)
+        cols = ["scenario", "platform", "cipher", "payload", "workload",
+                "reports", "motes", "iterations", "bytes", "cpu_ticks",
+                "lpm_ticks", "tx_ticks", "rx_ticks", "aead_ticks",
+                "energy_mj", "uj_per_byte"]
+    else:
+        cols = COLUMNS
+
+    w = csv.DictWriter(sys.stdout, fieldnames=cols, extrasaction="ignore")
+    w.writeheader()
+    w.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
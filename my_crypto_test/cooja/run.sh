@@ -0,0 +1,130 @@
+#!/bin/sh
+#---------------------------------------------------------------------------#
+#  examples/my_crypto_test/cooja/run.sh
+#  Run the Cooja scenarios headless over a cipher/platform/payload matrix
+#---------------------------------------------------------------------------#
+#
+# usage: cooja/run.sh [-s "bench net profile"] [-t "sky z1"] [-c "ascon aes ..."]
+#                     [-p "16 32 64"] [-n nodes] [-d seconds] [-r rounds]
+#                     [-o outdir]
+#
+# Each run leaves <outdir>/<scenario>-<target>-<cipher>-<payload>.testlog
+# (cipher "all" for bench, which measures every cipher in one firmware),
+# ready for cooja/parse_logs.py:
+#
+#   cooja/run.sh -s net -t "sky z1" -p "16 32 64"
+#   cooja/parse_logs.py results/*.testlog > results.csv
+#
+# The profile scenario is not in the default set: it builds
+# my_crypto_test with ITER=10, traces every function call in MSPSim for
+# one round and leaves the mspprof.py report in
+# <outdir>/profile-<target>-all-<payload>.txt (the raw trace stays in
+# <outdir>/profile-<target>-all-<payload>.d/).
+#
+# Firmware is rebuilt for every combination. CONTIKI points at the
+# Contiki-NG tree (default ../.. as for the Makefile). COOJA replaces
+# the gradle launcher with any headless Cooja command line; it is
+# called as  $COOJA --logdir=<dir> <scenario.csc>.
+
+set -e
+
+APP_DIR=$(cd "$(dirname "$0")/.." && pwd)
+CONTIKI=${CONTIKI:-$APP_DIR/../..}
+COOJA=${COOJA:-}
+
+SCENARIOS="bench net"
+TARGETS="sky z1"
+CIPHERS="ascon aes speck present"
+PAYLOADS="32"
+NODES=25
+DURATION=1800
+ROUNDS=3
+OUT=$APP_DIR/results
+
+while getopts "s:t:c:p:n:d:r:o:" opt; do
+  case $opt in
+    s) SCENARIOS=$OPTARG ;;
+    t) TARGETS=$OPTARG ;;
+    c) CIPHERS=$OPTARG ;;
+    p) PAYLOADS=$OPTARG ;;
+    n) NODES=$OPTARG ;;
+    d) DURATION=$OPTARG ;;
+    r) ROUNDS=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) sed -n 's/^# usage: /usage: /p' "$0" >&2; exit 2 ;;
+  esac
+done
+
+mkdir -p "$OUT"
+OUT=$(cd "$OUT" && pwd)
+
+# cooja logdir csc
+cooja() {
+  if [ -n "$COOJA" ]; then
+    # shellcheck disable=SC2086
+    $COOJA "--logdir=$1" "$2"
+  else
+    "$CONTIKI/tools/cooja/gradlew" --no-watch-fs --quiet \
+      -p "$CONTIKI/tools/cooja" run \
+      --args="--contiki=$CONTIKI --no-gui --logdir=$1 $2"
+  fi
+}
+
+# run_one scenario target cipher payload
+run_one() {
+  scenario=$1 target=$2 cipher=$3 payload=$4
+  name=$scenario-$target-$cipher-$payload
+  work=$OUT/$name.d
+  if [ "$scenario" = bench ]; then
+    app=my_crypto_test
+    opts="-r $ROUNDS"
+    cipher_var=
+  elif [ "$scenario" = profile ]; then
+    app=my_crypto_test
+    opts="-m $APP_DIR/build/$target/$app.map --trace $work/trace"
+    cipher_var=ITER=10
+  else
+    app=my_crypto_net
+    opts="-n $NODES -d $DURATION"
+    cipher_var=CIPHER=$cipher
+  fi
+
+  echo "== $name"
+  # CIPHER and PAYLOAD only change the application objects
+  rm -f "$APP_DIR/build/$target/obj/$app.o" "$APP_DIR/build/$target/$app.$target"
+  make -C "$APP_DIR" -s TARGET="$target" $cipher_var PAYLOAD="$payload" \
+       "$app.$target"
+
+  rm -rf "$work"
+  mkdir -p "$work"
+  # load the firmware just built: without --firmware Cooja runs make on
+  # it again, without CIPHER, PAYLOAD or ITER
+  # shellcheck disable=SC2086
+  "$APP_DIR/cooja/gen_csc.py" "$scenario" -t "$target" $opts \
+      --app-dir "$APP_DIR" --firmware "$APP_DIR/build/$target/$app.$target" \
+      > "$work/$name.csc"
+  if ! cooja "$work" "$work/$name.csc" > "$work/cooja.out" 2>&1; then
+    echo "   failed, see $work/cooja.out" >&2
+  fi
+  if [ -f "$work/COOJA.testlog" ]; then
+    mv "$work/COOJA.testlog" "$OUT/$name.testlog"
+  fi
+  if [ "$scenario" = profile ] && [ -s "$work/trace" ]; then
+    "$APP_DIR/cooja/mspprof.py" -m "$APP_DIR/build/$target/$app.map" \
+        "$work/trace" > "$OUT/$name.txt"
+  fi
+}
+
+for target in $TARGETS; do
+  for payload in $PAYLOADS; do
+    for scenario in $SCENARIOS; do
+      if [ "$scenario" = bench ] || [ "$scenario" = profile ]; then
+        run_one "$scenario" "$target" all "$payload"
+      else
+        for cipher in $CIPHERS; do
+          run_one net "$target" "$cipher" "$payload"
+        done
+      fi
+    done
+  done
+done
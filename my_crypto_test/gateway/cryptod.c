@@ -0,0 +1,524 @@
+/*
+ * cryptod.c
+ * Local batching crypto service for the gateway
+ *
+ * usage: cryptod [-s socket] [-t workers] [-b batch] [-w linger_us]
+ *                [-k cache_entries] [-i stats_interval_s]
+ *
+ * Clients (see cryptod_client.h) hand over request slots in a shared
+ * memory ring and ring a doorbell on a UNIX socket. The main thread
+ * only moves slot numbers into a queue; worker threads take up to
+ * `batch` requests at a time, run them against key_cache contexts and
+ * send one completion message per client per batch. Queue depth and
+ * request latency (doorbell to completion) are printed every interval.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "cryptod_proto.h"
+#include "key_cache.h"
+#include "lat_hist.h"
+
+#define MAX_CLIENTS 64
+#define QUEUE_LEN   65536          /* power of two */
+
+/* ------------------------------------------------------------------ */
+/*  State                                                             */
+/* ------------------------------------------------------------------ */
+
+struct conn {
+  int fd;
+  struct cryptod_slot *slots;
+  uint32_t nslots;
+  _Atomic int refs;                /* main thread + queued requests */
+  pthread_mutex_t send_lock;
+};
+
+struct job {
+  struct conn *conn;
+  uint32_t slot;
+  uint64_t t_enq;
+};
+
+static struct {
+  const char *path;
+  unsigned workers;
+  unsigned batch;
+  unsigned linger_us;
+  unsigned cache_entries;
+  unsigned interval;
+} cfg = { CRYPTOD_SOCK_PATH, 0, 32, 0, 65536, 5 };
+
+static struct key_cache cache;
+
+/* request queue */
+static pthread_mutex_t q_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  q_cond = PTHREAD_COND_INITIALIZER;
+static struct job queue[QUEUE_LEN];
+static unsigned q_head, q_tail;     /* pop at head, push at tail */
+static unsigned q_max_depth;
+static int stopping;
+
+/* statistics for the current interval, merged from workers */
+static pthread_mutex_t st_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct lat_hist st_lat, st_total;
+static unsigned long st_batches, st_failed;
+static unsigned long st_total_batches, st_total_failed;
+
+static volatile sig_atomic_t quit;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Connections                                                       */
+/* ------------------------------------------------------------------ */
+
+static void conn_put(struct conn *c) {
+  if(atomic_fetch_sub(&c->refs, 1) == 1) {
+    close(c->fd);
+    if(c->slots) {
+      munmap(c->slots, c->nslots * sizeof(*c->slots));
+    }
+    pthread_mutex_destroy(&c->send_lock);
+    free(c);
+  }
+}
+
+static void send_done(struct conn *c, const struct cryptod_done *d, unsigned n) {
+  pthread_mutex_lock(&c->send_lock);
+  /* a vanished client just loses its completions */
+  send(c->fd, d, n * sizeof(*d), MSG_NOSIGNAL);
+  pthread_mutex_unlock(&c->send_lock);
+}
+
+/* Receive the hello and its memfd, map the slots, echo the hello */
+static int conn_hello(struct conn *c) {
+  struct cryptod_hello h;
+  struct stat st;
+  size_t size;
+  int seals;
+  char cbuf[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = { &h, sizeof(h) };
+  struct msghdr msg = {
+    .msg_iov = &iov, .msg_iovlen = 1,
+    .msg_control = cbuf, .msg_controllen = sizeof(cbuf)
+  };
+  struct cmsghdr *cm;
+  int memfd = -1;
+
+  if(recvmsg(c->fd, &msg, 0) != sizeof(h)) {
+    return -1;
+  }
+  for(cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+    if(cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+      memcpy(&memfd, CMSG_DATA(cm), sizeof(int));
+    }
+  }
+  if(memfd < 0) {
+    return -1;
+  }
+  if(h.magic != CRYPTOD_MAGIC || h.slots == 0 || h.slots > CRYPTOD_MAX_SLOTS) {
+    close(memfd);
+    return -1;
+  }
+  /*
+   * The mapping must stay backed: a client that shrank the file later
+   * would turn every worker access into SIGBUS. Require a memfd that
+   * is large enough now and sealed against shrinking.
+   */
+  size = h.slots * sizeof(*c->slots);
+  seals = fcntl(memfd, F_GET_SEALS);
+  if(seals < 0 || !(seals & F_SEAL_SHRINK) ||
+     fstat(memfd, &st) < 0 || (uint64_t)st.st_size < size) {
+    close(memfd);
+    return -1;
+  }
+  c->slots = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+  close(memfd);
+  if(c->slots == MAP_FAILED) {
+    c->slots = NULL;
+    return -1;
+  }
+  c->nslots = h.slots;
+  return send(c->fd, &h, sizeof(h), MSG_NOSIGNAL) == sizeof(h) ? 0 : -1;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Queue                                                             */
+/* ------------------------------------------------------------------ */
+
+/* Queue the doorbell's slots; returns how many did not fit */
+static unsigned enqueue(struct conn *c, const uint32_t *slots, unsigned n,
+                        struct cryptod_done *rejected) {
+  uint64_t t = now_ns();
+  unsigned nrej = 0;
+
+  pthread_mutex_lock(&q_lock);
+  for(unsigned i = 0; i < n; i++) {
+    if(slots[i] >= c->nslots) {
+      continue;     /* not a slot of this client: nothing to complete */
+    }
+    if(q_tail - q_head == QUEUE_LEN) {
+      rejected[nrej].slot = slots[i];
+      rejected[nrej++].status = CRYPTOD_EBUSY;
+      continue;
+    }
+    atomic_fetch_add(&c->refs, 1);
+    queue[q_tail++ % QUEUE_LEN] = (struct job){ c, slots[i], t };
+  }
+  if(q_tail - q_head > q_max_depth) {
+    q_max_depth = q_tail - q_head;
+  }
+  pthread_cond_signal(&q_cond);
+  pthread_mutex_unlock(&q_lock);
+  return nrej;
+}
+
+/* Take up to cfg.batch jobs, lingering for a fuller batch if asked */
+static unsigned dequeue(struct job *out) {
+  unsigned n = 0;
+
+  pthread_mutex_lock(&q_lock);
+  while(q_head == q_tail && !stopping) {
+    pthread_cond_wait(&q_cond, &q_lock);
+  }
+  if(cfg.linger_us && q_tail - q_head < cfg.batch && !stopping) {
+    struct timespec dl;
+    clock_gettime(CLOCK_REALTIME, &dl);
+    dl.tv_nsec += cfg.linger_us * 1000L;
+    dl.tv_sec  += dl.tv_nsec / 1000000000L;
+    dl.tv_nsec %= 1000000000L;
+    while(q_tail - q_head < cfg.batch && !stopping &&
+          pthread_cond_timedwait(&q_cond, &q_lock, &dl) != ETIMEDOUT) {
+    }
+  }
+  while(n < cfg.batch && q_head != q_tail) {
+    out[n++] = queue[q_head++ % QUEUE_LEN];
+  }
+  /* leftovers: let another worker start on them */
+  if(q_head != q_tail) {
+    pthread_cond_signal(&q_cond);
+  }
+  pthread_mutex_unlock(&q_lock);
+  return n;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Workers                                                           */
+/* ------------------------------------------------------------------ */
+
+static int32_t process(struct cryptod_slot *s, uint8_t *scratch) {
+  /* read the request header once: the client shares this memory */
+  uint8_t op = s->op, cipher = s->cipher, tag_len = s->tag_len;
+  uint16_t ad_len = s->ad_len, len = s->len;
+  struct aead_ctx ctx;
+  uint8_t *buf = s->data;
+
+  if(op > CRYPTOD_VERIFY || cipher >= AEAD_NUM_CIPHERS ||
+     ad_len > CRYPTOD_MAX_AD || len > CRYPTOD_MAX_PAYLOAD ||
+     tag_len < CRYPTOD_MIN_TAG || !aead_tag_ok(cipher, tag_len)) {
+    return CRYPTOD_EINVAL;
+  }
+
+  ctx.cipher = cipher;
+  if(cipher == AEAD_ASCON) {
+    memcpy(ctx.key, s->key, AEAD_KEY_LEN);
+  } else {
+    key_cache_fetch(&cache, s->node, aead_block_cipher(cipher), s->key,
+                    &ctx.bc);
+  }
+
+  if(op == CRYPTOD_ENCRYPT) {
+    return aead_seal(&ctx, s->nonce, s->ad, ad_len, buf, len,
+                     s->tag, tag_len) ? CRYPTOD_EINVAL : CRYPTOD_OK;
+  }
+  if(op == CRYPTOD_VERIFY) {
+    memcpy(scratch, buf, len);
+    buf = scratch;
+  }
+  /* the parameters were checked above, so a failure is the tag */
+  return aead_open(&ctx, s->nonce, s->ad, ad_len, buf, len,
+                   s->tag, tag_len) ? CRYPTOD_EAUTH : CRYPTOD_OK;
+}
+
+static void *worker(void *arg) {
+  struct job *jobs = calloc(cfg.batch, sizeof(*jobs));
+  struct cryptod_done *done = calloc(cfg.batch, sizeof(*done));
+  uint8_t *scratch = malloc(CRYPTOD_MAX_PAYLOAD);
+  struct lat_hist *lat = malloc(sizeof(*lat));
+  (void)arg;
+
+  if(!jobs || !done || !scratch || !lat) {
+    perror("cryptod: worker");
+    exit(1);
+  }
+
+  for(;;) {
+    unsigned n = dequeue(jobs), failed = 0;
+    if(n == 0) {
+      break;        /* stopping and drained */
+    }
+
+    for(unsigned i = 0; i < n; i++) {
+      struct cryptod_slot *s = &jobs[i].conn->slots[jobs[i].slot];
+      s->status = process(s, scratch);
+      failed += s->status != CRYPTOD_OK;
+    }
+
+    /* one completion message per client in this batch */
+    for(unsigned i = 0; i < n; i++) {
+      struct conn *c = jobs[i].conn;
+      unsigned m = 0;
+      if(!c) {
+        continue;
+      }
+      for(unsigned j = i; j < n; j++) {
+        if(jobs[j].conn == c) {
+          done[m].slot = jobs[j].slot;
+          done[m++].status = c->slots[jobs[j].slot].status;
+          jobs[j].conn = NULL;
+        }
+      }
+      send_done(c, done, m);
+      for(unsigned j = 0; j < m; j++) {
+        conn_put(c);
+      }
+    }
+
+    uint64_t t = now_ns();
+    lat_hist_reset(lat);
+    for(unsigned i = 0; i < n; i++) {
+      lat_hist_add(lat, t - jobs[i].t_enq);
+    }
+
+    pthread_mutex_lock(&st_lock);
+    lat_hist_merge(&st_lat, lat);
+    st_batches++;
+    st_failed += failed;
+    pthread_mutex_unlock(&st_lock);
+  }
+
+  free(jobs);
+  free(done);
+  free(scratch);
+  free(lat);
+  return NULL;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Main loop                                                         */
+/* ------------------------------------------------------------------ */
+
+static void print_stats(double secs, int final) {
+  struct key_cache_stats ks;
+  struct lat_hist *h = final ? &st_total : &st_lat;
+  unsigned long batches, failed;
+  unsigned depth, max_depth;
+
+  pthread_mutex_lock(&q_lock);
+  depth = q_tail - q_head;
+  max_depth = q_max_depth;
+  q_max_depth = depth;
+  pthread_mutex_unlock(&q_lock);
+  key_cache_get_stats(&cache, &ks);
+
+  pthread_mutex_lock(&st_lock);
+  if(!final) {
+    lat_hist_merge(&st_total, &st_lat);
+    st_total_batches += st_batches;
+    st_total_failed  += st_failed;
+  }
+  batches = final ? st_total_batches : st_batches;
+  failed  = final ? st_total_failed : st_failed;
+  printf("%s%8.0f req/s  batch %5.1f  queue %u (max %u)  "
+         "lat us p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f  "
+         "failed %lu  key cache hit %.1f%%\n",
+         final ? "total " : "", h->count / secs,
+         batches ? (double)h->count / batches : 0.0,
+         depth, max_depth,
+         lat_hist_quantile(h, 0.50) / 1e3, lat_hist_quantile(h, 0.90) / 1e3,
+         lat_hist_quantile(h, 0.99) / 1e3, lat_hist_quantile(h, 0.999) / 1e3,
+         h->max / 1e3, failed,
+         ks.hits + ks.misses ? 100.0 * ks.hits / (ks.hits + ks.misses) : 0.0);
+  fflush(stdout);
+  if(!final) {
+    lat_hist_reset(&st_lat);
+    st_batches = 0;
+    st_failed = 0;
+  }
+  pthread_mutex_unlock(&st_lock);
+}
+
+static void on_signal(int sig) {
+  (void)sig;
+  quit = 1;
+}
+
+static int listen_on(const char *path) {
+  struct sockaddr_un sa = { .sun_family = AF_UNIX };
+  int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+  if(fd < 0 || strlen(path) >= sizeof(sa.sun_path)) {
+    return -1;
+  }
+  strcpy(sa.sun_path, path);
+  unlink(path);
+  if(bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(fd, 16) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: cryptod [-s socket] [-t workers] [-b batch] "
+                  "[-w linger_us] [-k cache_entries] [-i interval_s]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  struct pollfd pfd[1 + MAX_CLIENTS];
+  struct conn *conns[1 + MAX_CLIENTS];
+  unsigned nfds = 1;
+  uint32_t bell[CRYPTOD_MAX_MSG];
+  struct cryptod_done rej[CRYPTOD_MAX_MSG];
+  uint64_t t_start, t_last;
+  int opt;
+
+  while((opt = getopt(argc, argv, "s:t:b:w:k:i:")) != -1) {
+    switch(opt) {
+    case 's': cfg.path = optarg; break;
+    case 't': cfg.workers = strtoul(optarg, NULL, 0); break;
+    case 'b': cfg.batch = strtoul(optarg, NULL, 0); break;
+    case 'w': cfg.linger_us = strtoul(optarg, NULL, 0); break;
+    case 'k': cfg.cache_entries = strtoul(optarg, NULL, 0); break;
+    case 'i': cfg.interval = strtoul(optarg, NULL, 0); break;
+    default:  usage();
+    }
+  }
+  if(cfg.workers == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    cfg.workers = n > 0 ? n : 1;
+  }
+  if(cfg.batch == 0 || cfg.batch > CRYPTOD_MAX_MSG || cfg.interval == 0) {
+    usage();
+  }
+
+  if(key_cache_init(&cache, cfg.cache_entries) != 0) {
+    fprintf(stderr, "cryptod: cannot allocate key cache\n");
+    return 1;
+  }
+  pfd[0].fd = listen_on(cfg.path);
+  pfd[0].events = POLLIN;
+  if(pfd[0].fd < 0) {
+    perror(cfg.path);
+    return 1;
+  }
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+  signal(SIGPIPE, SIG_IGN);
+
+  pthread_t tid[cfg.workers];
+  for(unsigned i = 0; i < cfg.workers; i++) {
+    pthread_create(&tid[i], NULL, worker, NULL);
+  }
+  printf("cryptod: %s, %u workers, batch %u, linger %u us, %u cached keys\n",
+         cfg.path, cfg.workers, cfg.batch, cfg.linger_us, cfg.cache_entries);
+  fflush(stdout);
+
+  t_start = t_last = now_ns();
+  while(!quit) {
+    int r = poll(pfd, nfds, 200);
+    uint64_t t = now_ns();
+
+    if(t - t_last >= cfg.interval * 1000000000ull) {
+      print_stats((t - t_last) / 1e9, 0);
+      t_last = t;
+    }
+    if(r <= 0) {
+      continue;
+    }
+
+    if(pfd[0].revents & POLLIN) {
+      int fd = accept4(pfd[0].fd, NULL, NULL, SOCK_CLOEXEC);
+      struct conn *c = fd >= 0 ? calloc(1, sizeof(*c)) : NULL;
+      if(c) {
+        /* a client that never says hello must not stall the loop */
+        struct timeval tv = { 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        c->fd = fd;
+        atomic_init(&c->refs, 1);
+        pthread_mutex_init(&c->send_lock, NULL);
+      }
+      if(c && nfds <= MAX_CLIENTS && conn_hello(c) == 0) {
+        conns[nfds] = c;
+        pfd[nfds].fd = fd;
+        pfd[nfds++].events = POLLIN;
+      } else if(c) {
+        conn_put(c);
+      } else if(fd >= 0) {
+        close(fd);
+      }
+    }
+
+    for(unsigned i = 1; i < nfds; i++) {
+      if(!pfd[i].revents) {
+        continue;
+      }
+      ssize_t len = recv(pfd[i].fd, bell, sizeof(bell), MSG_DONTWAIT);
+      if(len > 0) {
+        unsigned nrej = enqueue(conns[i], bell, len / sizeof(bell[0]), rej);
+        if(nrej) {
+          send_done(conns[i], rej, nrej);
+        }
+      } else if(len == 0 || (errno != EAGAIN && errno != EINTR)) {
+        /* client gone: queued jobs still hold references */
+        conn_put(conns[i]);
+        conns[i] = conns[--nfds];
+        pfd[i] = pfd[nfds];
+        i--;
+      }
+    }
+  }
+
+  pthread_mutex_lock(&q_lock);
+  stopping = 1;
+  pthread_cond_broadcast(&q_cond);
+  pthread_mutex_unlock(&q_lock);
+  for(unsigned i = 0; i < cfg.workers; i++) {
+    pthread_join(tid[i], NULL);
+  }
+  lat_hist_merge(&st_total, &st_lat);
+  st_total_batches += st_batches;
+  st_total_failed  += st_failed;
+  print_stats((now_ns() - t_start) / 1e9, 1);
+
+  for(unsigned i = 1; i < nfds; i++) {
+    conn_put(conns[i]);
+  }
+  close(pfd[0].fd);
+  unlink(cfg.path);
+  key_cache_free(&cache);
+  return 0;
+}
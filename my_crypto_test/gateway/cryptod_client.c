@@ -0,0 +1,111 @@
+/* cryptod_client.c */
+#define _GNU_SOURCE
+#include "cryptod_client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int cryptod_connect(struct cryptod_client *c, const char *path,
+                    uint32_t nslots) {
+  struct sockaddr_un sa = { .sun_family = AF_UNIX };
+  struct cryptod_hello h = { CRYPTOD_MAGIC, nslots }, ack;
+  size_t size = nslots * sizeof(*c->slots);
+  char cbuf[CMSG_SPACE(sizeof(int))];
+  struct iovec iov = { &h, sizeof(h) };
+  struct msghdr msg = {
+    .msg_iov = &iov, .msg_iovlen = 1,
+    .msg_control = cbuf, .msg_controllen = sizeof(cbuf)
+  };
+  struct cmsghdr *cm;
+  int memfd;
+
+  if(!path) path = CRYPTOD_SOCK_PATH;
+  if(nslots == 0 || nslots > CRYPTOD_MAX_SLOTS ||
+     strlen(path) >= sizeof(sa.sun_path)) {
+    errno = EINVAL;
+    return -1;
+  }
+  strcpy(sa.sun_path, path);
+
+  c->fd = -1;
+  c->slots = NULL;
+  /* cryptod only maps a memfd that cannot shrink under it */
+  memfd = memfd_create("cryptod-slots", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if(memfd < 0 || ftruncate(memfd, size) < 0 ||
+     fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK) < 0) {
+    goto fail;
+  }
+  c->slots = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+  if(c->slots == MAP_FAILED) {
+    c->slots = NULL;
+    goto fail;
+  }
+  c->nslots = nslots;
+
+  c->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if(c->fd < 0 || connect(c->fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+    goto fail;
+  }
+  cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type  = SCM_RIGHTS;
+  cm->cmsg_len   = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cm), &memfd, sizeof(int));
+  if(sendmsg(c->fd, &msg, 0) != sizeof(h) ||
+     recv(c->fd, &ack, sizeof(ack), 0) != sizeof(ack)) {
+    goto fail;
+  }
+  if(ack.magic != CRYPTOD_MAGIC || ack.slots != nslots) {
+    errno = EPROTO;
+    goto fail;
+  }
+  close(memfd);
+  return 0;
+
+fail:
+  {
+    int e = errno;
+    if(memfd >= 0) close(memfd);
+    cryptod_disconnect(c);
+    errno = e;
+  }
+  return -1;
+}
+
+int cryptod_submit(struct cryptod_client *c, const uint32_t *slots,
+                   unsigned n) {
+  while(n) {
+    unsigned m = n < CRYPTOD_MAX_MSG ? n : CRYPTOD_MAX_MSG;
+    if(send(c->fd, slots, m * sizeof(*slots), MSG_NOSIGNAL) < 0) {
+      return -1;
+    }
+    slots += m;
+    n -= m;
+  }
+  return 0;
+}
+
+int cryptod_complete(struct cryptod_client *c, struct cryptod_done *done,
+                     unsigned max) {
+  ssize_t len;
+  do {
+    len = recv(c->fd, done, max * sizeof(*done), 0);
+  } while(len < 0 && errno == EINTR);
+  return len <= 0 ? -1 : (int)(len / sizeof(*done));
+}
+
+void cryptod_disconnect(struct cryptod_client *c) {
+  if(c->fd >= 0) {
+    close(c->fd);
+  }
+  if(c->slots) {
+    munmap(c->slots, c->nslots * sizeof(*c->slots));
+  }
+  c->fd = -1;
+  c->slots = NULL;
+}
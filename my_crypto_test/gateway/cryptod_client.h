@@ -0,0 +1,51 @@
+/* cryptod_client.h */
+#ifndef CRYPTOD_CLIENT_H
+#define CRYPTOD_CLIENT_H
+
+#include <stdint.h>
+
+#include "cryptod_proto.h"
+
+/*
+ * Client side of cryptod: owns the shared slot ring and the socket.
+ * Fill c->slots[i], cryptod_submit() it, and wait for its completion
+ * with cryptod_complete(); do not touch the slot in between.
+ */
+
+struct cryptod_client {
+  int fd;
+  struct cryptod_slot *slots;
+  uint32_t nslots;
+};
+
+/**
+ * cryptod_connect(c, path, nslots):
+ *
+ * Create an nslots shared ring and register it with the daemon at
+ * path (NULL = CRYPTOD_SOCK_PATH). Returns 0, or -1 with errno set.
+ */
+int cryptod_connect(struct cryptod_client *c, const char *path,
+                    uint32_t nslots);
+
+/**
+ * cryptod_submit(c, slots, n):
+ *
+ * Hand n filled slots to the daemon (split into CRYPTOD_MAX_MSG-sized
+ * doorbells). Returns 0, or -1 if the socket failed.
+ */
+int cryptod_submit(struct cryptod_client *c, const uint32_t *slots,
+                   unsigned n);
+
+/**
+ * cryptod_complete(c, done, max):
+ *
+ * Block until at least one completion arrives; store up to max of them
+ * (max >= CRYPTOD_MAX_MSG avoids truncation). Returns the count, or -1
+ * if the daemon went away.
+ */
+int cryptod_complete(struct cryptod_client *c, struct cryptod_done *done,
+                     unsigned max);
+
+void cryptod_disconnect(struct cryptod_client *c);
+
+#endif /* CRYPTOD_CLIENT_H */
@@ -0,0 +1,211 @@
+/*
+ * cryptod_load.c
+ * Loopback client and load generator for cryptod
+ *
+ * usage: cryptod_load [-s socket] [-c cipher] [-o op] [-l payload]
+ *                     [-a ad_len] [-T tag_len] [-d depth] [-n requests]
+ *                     [-N nodes]
+ *   cipher  ascon | aes | speck | present          (default aes)
+ *   op      encrypt | decrypt | verify             (default encrypt)
+ *   depth   requests kept in flight                (default 64)
+ *
+ * Requests are copied from a pool of POOL prepared ones (pre-sealed for
+ * decrypt/verify), so the client adds no crypto of its own. Every
+ * completion is checked: encryptions are opened locally once per slot,
+ * decrypt/verify requests must authenticate. Prints throughput and
+ * client-side round-trip latency percentiles.
+ */
+
+#define _GNU_SOURCE
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cryptod_client.h"
+#include "lat_hist.h"
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void node_key(uint32_t node, uint8_t key[AEAD_KEY_LEN]) {
+  for(int i = 0; i < AEAD_KEY_LEN; i++) key[i] = (uint8_t)(node >> (8 * (i & 3))) ^ i;
+}
+
+#define POOL 256       /* distinct prepared requests */
+
+static const char *path;
+static int cipher = AEAD_AES, op = CRYPTOD_ENCRYPT;
+static unsigned len = 64, ad_len = 8, tag_len = 8, depth = 64, nodes = 1000;
+static unsigned long total = 200000;
+static struct cryptod_client cl;
+static struct cryptod_slot *pool;   /* requests, sealed for decrypt/verify */
+static uint16_t *from;              /* pool entry each slot was filled from */
+static uint8_t *checked;
+static uint32_t rng = 1;
+
+/* Prepare pool entry p for a random node */
+static void prepare(unsigned p) {
+  struct cryptod_slot *s = &pool[p];
+
+  rng ^= rng << 13;  rng ^= rng >> 17;  rng ^= rng << 5;
+  s->op = op;
+  s->cipher = cipher;
+  s->tag_len = tag_len;
+  s->node = rng % nodes;
+  s->ad_len = ad_len;
+  s->len = len;
+  node_key(s->node, s->key);
+  memset(s->nonce, 0, sizeof(s->nonce));
+  memcpy(s->nonce, &p, sizeof(p));
+  memset(s->ad, 0xAD, ad_len);
+  memset(s->data, (uint8_t)p, len);
+  if(op != CRYPTOD_ENCRYPT) {
+    struct aead_ctx ctx;
+    aead_init(&ctx, cipher, s->key);
+    aead_seal(&ctx, s->nonce, s->ad, ad_len, s->data, len, s->tag, tag_len);
+  }
+}
+
+/* Copy a random pool entry into slot i: the client only does memcpy */
+static void fill(uint32_t i) {
+  rng ^= rng << 13;  rng ^= rng >> 17;  rng ^= rng << 5;
+  from[i] = rng % POOL;
+  memcpy(&cl.slots[i], &pool[from[i]],
+         offsetof(struct cryptod_slot, data) + len);
+}
+
+/* The first encryption result of each slot is opened locally */
+static int check(uint32_t i) {
+  struct cryptod_slot *s = &cl.slots[i];
+  struct aead_ctx ctx;
+
+  if(op != CRYPTOD_ENCRYPT || checked[i]) {
+    return 0;
+  }
+  checked[i] = 1;
+  aead_init(&ctx, cipher, s->key);
+  if(aead_open(&ctx, s->nonce, s->ad, s->ad_len, s->data, s->len,
+               s->tag, s->tag_len) != 0) {
+    return -1;
+  }
+  return memcmp(s->data, pool[from[i]].data, s->len) ? -1 : 0;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: cryptod_load [-s socket] [-c cipher] [-o op] "
+                  "[-l payload] [-a ad_len] [-T tag_len] [-d depth] "
+                  "[-n requests] [-N nodes]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  unsigned long sent = 0, received = 0, errors = 0;
+  struct cryptod_done done[CRYPTOD_MAX_MSG];
+  struct lat_hist *lat = malloc(sizeof(*lat));
+  uint64_t *t_sub, t0, t1;
+  uint32_t *pending;
+  int opt;
+
+  while((opt = getopt(argc, argv, "s:c:o:l:a:T:d:n:N:")) != -1) {
+    switch(opt) {
+    case 's': path = optarg; break;
+    case 'c': cipher = aead_from_name(optarg); break;
+    case 'o':
+      op = !strcmp(optarg, "encrypt") ? CRYPTOD_ENCRYPT
+         : !strcmp(optarg, "decrypt") ? CRYPTOD_DECRYPT
+         : !strcmp(optarg, "verify")  ? CRYPTOD_VERIFY : -1;
+      break;
+    case 'l': len = strtoul(optarg, NULL, 0); break;
+    case 'a': ad_len = strtoul(optarg, NULL, 0); break;
+    case 'T': tag_len = strtoul(optarg, NULL, 0); break;
+    case 'd': depth = strtoul(optarg, NULL, 0); break;
+    case 'n': total = strtoul(optarg, NULL, 0); break;
+    case 'N': nodes = strtoul(optarg, NULL, 0); break;
+    default:  usage();
+    }
+  }
+  if(cipher < 0 || op < 0 || len > CRYPTOD_MAX_PAYLOAD ||
+     ad_len > CRYPTOD_MAX_AD || tag_len > AEAD_TAG_MAX ||
+     !aead_tag_ok(cipher, tag_len) ||
+     depth == 0 || depth > CRYPTOD_MAX_SLOTS || nodes == 0 || !lat) {
+    usage();
+  }
+
+  if(cryptod_connect(&cl, path, depth) != 0) {
+    perror("cryptod_load: connect");
+    return 1;
+  }
+  t_sub   = calloc(depth, sizeof(*t_sub));
+  pending = calloc(depth, sizeof(*pending));
+  checked = calloc(depth, 1);
+  from    = calloc(depth, sizeof(*from));
+  pool    = calloc(POOL, sizeof(*pool));
+  if(!t_sub || !pending || !checked || !from || !pool) {
+    perror("cryptod_load");
+    return 1;
+  }
+  lat_hist_reset(lat);
+  for(unsigned p = 0; p < POOL; p++) {
+    prepare(p);
+  }
+
+  t0 = now_ns();
+  unsigned n = 0;
+  for(uint32_t i = 0; i < depth && sent < total; i++, sent++) {
+    fill(i);
+    t_sub[i] = now_ns();
+    pending[n++] = i;
+  }
+  cryptod_submit(&cl, pending, n);
+
+  while(received < sent) {
+    int m = cryptod_complete(&cl, done, CRYPTOD_MAX_MSG);
+    uint64_t t = now_ns();
+    if(m < 0) {
+      fprintf(stderr, "cryptod_load: daemon closed the connection\n");
+      return 1;
+    }
+    n = 0;
+    for(int k = 0; k < m; k++) {
+      uint32_t i = done[k].slot;
+      received++;
+      lat_hist_add(lat, t - t_sub[i]);
+      if(done[k].status != CRYPTOD_OK || check(i) != 0) {
+        errors++;
+      }
+      if(sent < total) {
+        fill(i);
+        t_sub[i] = now_ns();
+        pending[n++] = i;
+        sent++;
+      }
+    }
+    if(n && cryptod_submit(&cl, pending, n) != 0) {
+      perror("cryptod_load: submit");
+      return 1;
+    }
+  }
+  t1 = now_ns();
+
+  double secs = (t1 - t0) / 1e9;
+  printf("%s %s, %u B payload, %u B AD, %u B tag, depth %u, %u nodes\n",
+         aead_name(cipher),
+         op == CRYPTOD_ENCRYPT ? "encrypt" : op == CRYPTOD_DECRYPT ? "decrypt" : "verify",
+         len, ad_len, tag_len, depth, nodes);
+  printf("  %lu requests in %.2f s: %.0f req/s, %.2f MB/s, %lu errors\n",
+         received, secs, received / secs, received * (double)len / secs / 1e6,
+         errors);
+  printf("  round trip us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+         lat_hist_quantile(lat, 0.50) / 1e3, lat_hist_quantile(lat, 0.90) / 1e3,
+         lat_hist_quantile(lat, 0.99) / 1e3, lat_hist_quantile(lat, 0.999) / 1e3,
+         lat->max / 1e3);
+
+  cryptod_disconnect(&cl);
+  return errors ? 2 : 0;
+}
@@ -0,0 +1,75 @@
+/* cryptod_proto.h */
+#ifndef CRYPTOD_PROTO_H
+#define CRYPTOD_PROTO_H
+
+#include <stdint.h>
+
+#include "aead.h"
+
+/*
+ * Wire protocol between cryptod and its local clients.
+ *
+ * A client connects to the SOCK_SEQPACKET socket and sends a
+ * struct cryptod_hello carrying a memfd (SCM_RIGHTS) that holds
+ * hello.slots request slots, at least hello.slots * sizeof(struct
+ * cryptod_slot) bytes and sealed with F_SEAL_SHRINK; the daemon maps
+ * it and echoes the hello, or hangs up if the memfd does not qualify.
+ * From then on payloads never cross the socket:
+ *
+ *   client -> daemon   uint32_t slot[]              ("doorbell")
+ *   daemon -> client   struct cryptod_done[]        (completions)
+ *
+ * A slot belongs to the daemon from its doorbell until its completion.
+ */
+
+#define CRYPTOD_SOCK_PATH   "/tmp/cryptod.sock"
+#define CRYPTOD_MAGIC       0x43525944u   /* "CRYD" */
+
+#define CRYPTOD_MAX_SLOTS   1024
+#define CRYPTOD_MAX_AD      64
+#define CRYPTOD_MAX_PAYLOAD 4096
+#define CRYPTOD_MAX_MSG     256   /* slots per doorbell/completion message */
+#define CRYPTOD_MIN_TAG     4     /* shortest tag the daemon accepts */
+
+enum cryptod_op {
+  CRYPTOD_ENCRYPT,    /* seal data in place, write tag */
+  CRYPTOD_DECRYPT,    /* open data in place, check tag */
+  CRYPTOD_VERIFY      /* check tag only, data left as ciphertext */
+};
+
+enum cryptod_status {
+  CRYPTOD_OK     =  0,
+  CRYPTOD_EAUTH  = -1,    /* tag mismatch */
+  CRYPTOD_EINVAL = -2,    /* bad op, cipher or length (tag_len too) */
+  CRYPTOD_EBUSY  = -3     /* daemon queue full, resubmit later */
+};
+
+struct cryptod_hello {
+  uint32_t magic;
+  uint32_t slots;
+};
+
+struct cryptod_slot {
+  /* request, written by the client */
+  uint8_t  op;          /* enum cryptod_op */
+  uint8_t  cipher;      /* enum aead_cipher */
+  uint8_t  tag_len;
+  uint8_t  reserved;
+  uint32_t node;        /* key-cache key: one key per node */
+  uint16_t ad_len;
+  uint16_t len;
+  uint8_t  key[AEAD_KEY_LEN];
+  uint8_t  nonce[AEAD_NONCE_MAX];
+  uint8_t  tag[AEAD_TAG_MAX];
+  uint8_t  ad[CRYPTOD_MAX_AD];
+  uint8_t  data[CRYPTOD_MAX_PAYLOAD];
+  /* result, written by the daemon */
+  int32_t  status;      /* enum cryptod_status */
+} __attribute__((aligned(64)));
+
+struct cryptod_done {
+  uint32_t slot;
+  int32_t  status;
+};
+
+#endif /* CRYPTOD_PROTO_H */
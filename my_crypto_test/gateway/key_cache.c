@@ -0,0 +1,200 @@
+/* key_cache.c */
+#include "key_cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Internal helpers (static)                                         */
+/* ------------------------------------------------------------------ */
+
+/* Each thread bumps its own counter stripe, assigned on first use */
+static _Atomic unsigned next_stripe;
+static _Thread_local unsigned my_stripe = ~0u;
+
+static inline struct key_cache_counters *counters(struct key_cache *c) {
+  if(my_stripe == ~0u) {
+    my_stripe = atomic_fetch_add_explicit(&next_stripe, 1, memory_order_relaxed)
+                % KEY_CACHE_STRIPES;
+  }
+  return &c->stats[my_stripe];
+}
+
+#define COUNT(c, field) \
+  atomic_fetch_add_explicit(&counters(c)->field, 1, memory_order_relaxed)
+
+static inline uint32_t set_index(const struct key_cache *c, uint32_t node) {
+  /* Fibonacci hashing spreads consecutive node IDs over sets */
+  uint32_t h = node * 0x9E3779B1u;
+  return (h ^ h >> 16) & c->set_mask;
+}
+
+static inline struct block_cipher_ctx *entry(struct key_cache *c,
+                                             uint32_t set, unsigned way) {
+  return &c->entries[set * KEY_CACHE_WAYS + way].ctx;
+}
+
+static void lock_set(struct key_cache_set *s) {
+  while(atomic_flag_test_and_set_explicit(&s->lock, memory_order_acquire)) {
+    /* spin: writers hold the lock only for one key expansion copy */
+  }
+}
+
+static void unlock_set(struct key_cache_set *s) {
+  atomic_flag_clear_explicit(&s->lock, memory_order_release);
+}
+
+/* Choose the way to (re)write: the node's own, an empty one, or CLOCK */
+static unsigned pick_way(struct key_cache *c, struct key_cache_set *s,
+                         uint32_t node) {
+  unsigned w;
+  for(w = 0; w < KEY_CACHE_WAYS; w++) {
+    uint32_t seq = atomic_load_explicit(&s->seq[w], memory_order_relaxed);
+    if(seq && atomic_load_explicit(&s->node[w], memory_order_relaxed) == node) {
+      return w;
+    }
+  }
+  for(w = 0; w < KEY_CACHE_WAYS; w++) {
+    if(atomic_load_explicit(&s->seq[w], memory_order_relaxed) == 0) {
+      return w;
+    }
+  }
+  while(atomic_exchange_explicit(&s->ref[s->hand], 0, memory_order_relaxed)) {
+    s->hand = (s->hand + 1) % KEY_CACHE_WAYS;
+  }
+  w = s->hand;
+  s->hand = (s->hand + 1) % KEY_CACHE_WAYS;
+  COUNT(c, evictions);
+  return w;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API implementations                                        */
+/* ------------------------------------------------------------------ */
+
+int key_cache_init(struct key_cache *c, unsigned capacity) {
+  uint32_t sets = 1;
+  while(sets * KEY_CACHE_WAYS < capacity) sets <<= 1;
+
+  c->set_mask = sets - 1;
+  c->sets = aligned_alloc(KEY_CACHE_LINE, sets * sizeof(*c->sets));
+  c->entries = aligned_alloc(KEY_CACHE_LINE,
+                             sets * KEY_CACHE_WAYS * sizeof(*c->entries));
+  if(!c->sets || !c->entries) {
+    key_cache_free(c);
+    return -1;
+  }
+  memset(c->sets, 0, sets * sizeof(*c->sets));
+  for(uint32_t i = 0; i < sets; i++) {
+    atomic_flag_clear(&c->sets[i].lock);
+  }
+  for(unsigned i = 0; i < KEY_CACHE_STRIPES; i++) {
+    atomic_init(&c->stats[i].hits, 0);
+    atomic_init(&c->stats[i].misses, 0);
+    atomic_init(&c->stats[i].evictions, 0);
+  }
+  return 0;
+}
+
+void key_cache_free(struct key_cache *c) {
+  free(c->sets);
+  free(c->entries);
+  c->sets = NULL;
+  c->entries = NULL;
+}
+
+/* Seqlock read of node's entry; with key set, it must also match */
+static int lookup(struct key_cache *c, uint32_t node,
+                  const struct block_cipher *cipher, const uint8_t *key,
+                  struct block_cipher_ctx *out) {
+  uint32_t si = set_index(c, node);
+  struct key_cache_set *s = &c->sets[si];
+
+  for(unsigned w = 0; w < KEY_CACHE_WAYS; w++) {
+    for(;;) {
+      uint32_t s1 = atomic_load_explicit(&s->seq[w], memory_order_acquire);
+      if(s1 == 0 ||
+         atomic_load_explicit(&s->node[w], memory_order_relaxed) != node) {
+        break;
+      }
+      if(s1 & 1) {
+        continue;   /* writer in progress */
+      }
+      const struct key_cache_entry *e = &c->entries[si * KEY_CACHE_WAYS + w];
+      int match = !key || (e->ctx.cipher == cipher &&
+                           memcmp(e->key, key, cipher->key_len) == 0);
+      if(match) {
+        memcpy(out, &e->ctx, sizeof(*out));
+      }
+      atomic_thread_fence(memory_order_acquire);
+      if(atomic_load_explicit(&s->seq[w], memory_order_relaxed) != s1) {
+        continue;   /* torn read, try again */
+      }
+      if(!match) {
+        break;
+      }
+      /* only dirty the set's line if the bit is not already set */
+      if(!atomic_load_explicit(&s->ref[w], memory_order_relaxed)) {
+        atomic_store_explicit(&s->ref[w], 1, memory_order_relaxed);
+      }
+      COUNT(c, hits);
+      return 1;
+    }
+  }
+  COUNT(c, misses);
+  return 0;
+}
+
+int key_cache_get(struct key_cache *c, uint32_t node,
+                  struct block_cipher_ctx *out) {
+  return lookup(c, node, NULL, NULL, out);
+}
+
+static void store(struct key_cache *c, uint32_t node,
+                  const struct block_cipher_ctx *ctx, const uint8_t *key) {
+  uint32_t si = set_index(c, node);
+  struct key_cache_set *s = &c->sets[si];
+
+  lock_set(s);
+  unsigned w = pick_way(c, s, node);
+  /* even while unlocked, since writers of a set are serialized */
+  uint32_t seq = atomic_load_explicit(&s->seq[w], memory_order_relaxed);
+  atomic_store_explicit(&s->seq[w], seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&s->node[w], node, memory_order_relaxed);
+  memcpy(entry(c, si, w), ctx, sizeof(*ctx));
+  memcpy(c->entries[si * KEY_CACHE_WAYS + w].key, key, ctx->cipher->key_len);
+  atomic_store_explicit(&s->ref[w], 1, memory_order_relaxed);
+  /* skip 0 on wrap-around, it marks an empty way */
+  atomic_store_explicit(&s->seq[w], seq + 2 ? seq + 2 : 2,
+                        memory_order_release);
+  unlock_set(s);
+}
+
+void key_cache_put(struct key_cache *c, uint32_t node,
+                   const struct block_cipher *cipher, const uint8_t *key) {
+  struct block_cipher_ctx ctx;
+  block_cipher_init(&ctx, cipher, key);
+  store(c, node, &ctx, key);
+}
+
+int key_cache_fetch(struct key_cache *c, uint32_t node,
+                    const struct block_cipher *cipher, const uint8_t *key,
+                    struct block_cipher_ctx *out) {
+  if(lookup(c, node, cipher, key, out)) {
+    return 1;
+  }
+  /* expand outside the set lock, then publish */
+  block_cipher_init(out, cipher, key);
+  store(c, node, out, key);
+  return 0;
+}
+
+void key_cache_get_stats(struct key_cache *c, struct key_cache_stats *st) {
+  memset(st, 0, sizeof(*st));
+  for(unsigned i = 0; i < KEY_CACHE_STRIPES; i++) {
+    const struct key_cache_counters *k = &c->stats[i];
+    st->hits      += atomic_load_explicit(&k->hits, memory_order_relaxed);
+    st->misses    += atomic_load_explicit(&k->misses, memory_order_relaxed);
+    st->evictions += atomic_load_explicit(&k->evictions, memory_order_relaxed);
+  }
+}
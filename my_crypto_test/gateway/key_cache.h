@@ -0,0 +1,101 @@
+/* key_cache.h */
+#ifndef KEY_CACHE_H
+#define KEY_CACHE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "block_cipher.h"
+
+/*
+ * Gateway cache of expanded key schedules, keyed by node ID.
+ *
+ * The cache is set-associative with KEY_CACHE_WAYS entries per set and a
+ * fixed capacity chosen at init, so memory never grows with the fleet.
+ * Eviction is CLOCK within a set. Lookups take no lock: each entry is
+ * guarded by a sequence counter (seqlock) and readers copy the context
+ * out, retrying if a writer replaced it meanwhile. Inserts serialize on
+ * a per-set spinlock, so writers on different sets never contend.
+ */
+
+#define KEY_CACHE_WAYS    4
+#define KEY_CACHE_LINE   64
+#define KEY_CACHE_STRIPES 16   /* counter copies, so threads don't share a line */
+
+/* Per-set metadata: everything a probe touches sits in one cache line */
+struct key_cache_set {
+  _Atomic uint32_t seq[KEY_CACHE_WAYS];   /* 0 = empty, odd = being written */
+  _Atomic uint32_t node[KEY_CACHE_WAYS];
+  _Atomic uint8_t  ref[KEY_CACHE_WAYS];   /* CLOCK reference bits */
+  uint8_t hand;
+  atomic_flag lock;
+} __attribute__((aligned(KEY_CACHE_LINE)));
+
+/* Expanded context and the key it came from, padded to cache lines */
+struct key_cache_entry {
+  struct block_cipher_ctx ctx;
+  uint8_t key[BLOCK_CIPHER_MAX_KEYLEN];
+} __attribute__((aligned(KEY_CACHE_LINE)));
+
+/* One stripe of the hit/miss/eviction counters */
+struct key_cache_counters {
+  _Atomic unsigned long hits;
+  _Atomic unsigned long misses;
+  _Atomic unsigned long evictions;
+} __attribute__((aligned(KEY_CACHE_LINE)));
+
+struct key_cache_stats {
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long evictions;
+};
+
+struct key_cache {
+  uint32_t set_mask;
+  struct key_cache_set *sets;
+  struct key_cache_entry *entries;    /* sets x KEY_CACHE_WAYS */
+  struct key_cache_counters stats[KEY_CACHE_STRIPES];
+};
+
+/**
+ * key_cache_init(c, capacity):
+ *
+ * Allocate room for at least capacity contexts (rounded up to a power
+ * of two number of sets). Returns 0, or -1 if allocation fails.
+ */
+int key_cache_init(struct key_cache *c, unsigned capacity);
+
+void key_cache_free(struct key_cache *c);
+
+/**
+ * key_cache_get(c, node, out):
+ *
+ * Lock-free lookup. On a hit copies the context into out and returns 1;
+ * returns 0 on a miss.
+ */
+int key_cache_get(struct key_cache *c, uint32_t node,
+                  struct block_cipher_ctx *out);
+
+/**
+ * key_cache_put(c, node, cipher, key):
+ *
+ * Expand key and store it for node, replacing any previous entry for the
+ * node or evicting the CLOCK victim of its set.
+ */
+void key_cache_put(struct key_cache *c, uint32_t node,
+                   const struct block_cipher *cipher, const uint8_t *key);
+
+/**
+ * key_cache_fetch(c, node, cipher, key, out):
+ *
+ * Per-packet entry point: hit if node is cached under the same cipher
+ * and key, otherwise expand key into out and insert it (so a rekeyed
+ * node simply replaces its entry). Returns 1 on a hit, 0 on a miss.
+ */
+int key_cache_fetch(struct key_cache *c, uint32_t node,
+                    const struct block_cipher *cipher, const uint8_t *key,
+                    struct block_cipher_ctx *out);
+
+void key_cache_get_stats(struct key_cache *c, struct key_cache_stats *st);
+
+#endif /* KEY_CACHE_H */
@@ -0,0 +1,126 @@
+/*
+ * key_cache_bench.c
+ * Gateway per-packet key setup: expand every packet vs. key_cache
+ *
+ * usage: key_cache_bench [cipher] [nodes] [capacity] [threads] [packets]
+ *   cipher    aes | speck | present          (default aes)
+ *   nodes     distinct node IDs in traffic   (default 5000)
+ *   capacity  cached contexts                (default 4096)
+ *   threads   worker threads                 (default 4)
+ *   packets   packets per thread             (default 1000000)
+ *
+ * Traffic is skewed: 80% of packets come from 20% of the nodes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "key_cache.h"
+
+static const struct block_cipher *cipher = &block_cipher_aes;
+static unsigned nodes    = 5000;
+static unsigned capacity = 4096;
+static unsigned threads  = 4;
+static unsigned long packets = 1000000;
+
+static struct key_cache cache;
+static int use_cache;
+
+/* stands in for the gateway keystore: a fixed key per node */
+static void node_key(uint32_t node, uint8_t key[16]) {
+  for(int i = 0; i < 16; i++) key[i] = (uint8_t)(node >> (8 * (i & 3))) ^ i;
+}
+
+static uint32_t xorshift32(uint32_t *x) {
+  *x ^= *x << 13;  *x ^= *x >> 17;  *x ^= *x << 5;
+  return *x;
+}
+
+static void *worker(void *arg) {
+  uint32_t rng = 0x9E3779B9u * (uint32_t)(uintptr_t)(arg) + 1;
+  unsigned hot = nodes / 5 ? nodes / 5 : 1;
+  struct block_cipher_ctx ctx;
+  uint8_t key[16], block[BLOCK_CIPHER_MAX_BLOCKLEN] = { 0 };
+
+  for(unsigned long p = 0; p < packets; p++) {
+    uint32_t r = xorshift32(&rng);
+    uint32_t node = (r % 10 < 8) ? xorshift32(&rng) % hot
+                                 : xorshift32(&rng) % nodes;
+    node_key(node, key);
+    if(use_cache) {
+      key_cache_fetch(&cache, node, cipher, key, &ctx);
+    } else {
+      block_cipher_init(&ctx, cipher, key);
+    }
+    block_cipher_encrypt(&ctx, block);
+  }
+  return NULL;
+}
+
+static double run(void) {
+  pthread_t tid[threads];
+  struct timespec t0, t1;
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for(unsigned t = 0; t < threads; t++) {
+    pthread_create(&tid[t], NULL, worker, (void *)(uintptr_t)t);
+  }
+  for(unsigned t = 0; t < threads; t++) {
+    pthread_join(tid[t], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv) {
+  const struct block_cipher *all[] = {
+    &block_cipher_aes, &block_cipher_speck, &block_cipher_present
+  };
+  struct key_cache_stats st;
+  double total, t_plain, t_cache;
+
+  if(argc > 1) {
+    cipher = NULL;
+    for(unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+      if(strcmp(argv[1], all[i]->name) == 0) cipher = all[i];
+    }
+    if(!cipher) {
+      fprintf(stderr, "unknown cipher '%s' (aes, speck, present)\n", argv[1]);
+      return 1;
+    }
+  }
+  if(argc > 2) nodes    = strtoul(argv[2], NULL, 0);
+  if(argc > 3) capacity = strtoul(argv[3], NULL, 0);
+  if(argc > 4) threads  = strtoul(argv[4], NULL, 0);
+  if(argc > 5) packets  = strtoul(argv[5], NULL, 0);
+  if(!nodes || !threads) {
+    fprintf(stderr, "nodes and threads must be non-zero\n");
+    return 1;
+  }
+
+  if(key_cache_init(&cache, capacity) != 0) {
+    fprintf(stderr, "cannot allocate cache for %u contexts\n", capacity);
+    return 1;
+  }
+  total = (double)packets * threads;
+
+  use_cache = 0;
+  t_plain = run();
+  use_cache = 1;
+  t_cache = run();
+  key_cache_get_stats(&cache, &st);
+
+  printf("cipher %s, %u nodes, %u cached contexts, %u threads\n",
+         cipher->name, nodes, (cache.set_mask + 1) * KEY_CACHE_WAYS, threads);
+  printf("  expand per packet : %8.2f Mpkt/s\n", total / t_plain / 1e6);
+  printf("  key_cache         : %8.2f Mpkt/s\n", total / t_cache / 1e6);
+  printf("  hits %lu  misses %lu  evictions %lu  hit rate %.1f%%\n",
+         st.hits, st.misses, st.evictions,
+         st.hits + st.misses ? 100.0 * st.hits / (st.hits + st.misses) : 0.0);
+
+  key_cache_free(&cache);
+  return 0;
+}
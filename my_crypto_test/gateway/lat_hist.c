@@ -0,0 +1,51 @@
+/* lat_hist.c */
+#include "lat_hist.h"
+#include <string.h>
+
+static unsigned bucket(uint64_t v) {
+  if(v < 16) {
+    return v;
+  }
+  unsigned e = 63 - __builtin_clzll(v);          /* floor(log2 v), >= 4 */
+  return 16 + (e - 4) * 8 + ((v >> (e - 3)) & 7);
+}
+
+static uint64_t bucket_floor(unsigned i) {
+  if(i < 16) {
+    return i;
+  }
+  unsigned e = (i - 16) / 8 + 4;
+  return (uint64_t)(8 + (i - 16) % 8) << (e - 3);
+}
+
+void lat_hist_reset(struct lat_hist *h) {
+  memset(h, 0, sizeof(*h));
+}
+
+void lat_hist_add(struct lat_hist *h, uint64_t ns) {
+  h->b[bucket(ns)]++;
+  h->count++;
+  h->sum += ns;
+  if(ns > h->max) h->max = ns;
+}
+
+void lat_hist_merge(struct lat_hist *dst, const struct lat_hist *src) {
+  for(unsigned i = 0; i < LAT_HIST_BUCKETS; i++) dst->b[i] += src->b[i];
+  dst->count += src->count;
+  dst->sum   += src->sum;
+  if(src->max > dst->max) dst->max = src->max;
+}
+
+uint64_t lat_hist_quantile(const struct lat_hist *h, double q) {
+  uint64_t rank = (uint64_t)(q * h->count), seen = 0;
+  if(h->count == 0) {
+    return 0;
+  }
+  for(unsigned i = 0; i < LAT_HIST_BUCKETS; i++) {
+    seen += h->b[i];
+    if(seen > rank) {
+      return bucket_floor(i);
+    }
+  }
+  return h->max;
+}
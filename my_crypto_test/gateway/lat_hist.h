@@ -0,0 +1,29 @@
+/* lat_hist.h */
+#ifndef LAT_HIST_H
+#define LAT_HIST_H
+
+#include <stdint.h>
+
+/*
+ * Log-linear latency histogram: exact below 16 ns, then 8 buckets per
+ * power of two (<= 12.5% error), covering the whole uint64_t range in
+ * a fixed 4 KB. Not thread-safe; keep one per thread and merge.
+ */
+
+#define LAT_HIST_BUCKETS (16 + 60 * 8)
+
+struct lat_hist {
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+  uint64_t b[LAT_HIST_BUCKETS];
+};
+
+void lat_hist_reset(struct lat_hist *h);
+void lat_hist_add(struct lat_hist *h, uint64_t ns);
+void lat_hist_merge(struct lat_hist *dst, const struct lat_hist *src);
+
+/* Value at quantile q (0..1), as the lower bound of its bucket */
+uint64_t lat_hist_quantile(const struct lat_hist *h, double q);
+
+#endif /* LAT_HIST_H */
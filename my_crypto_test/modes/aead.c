@@ -0,0 +1,73 @@
+/* aead.c */
+#include "aead.h"
+#include "ccm_star.h"
+#include <string.h>
+
+static const char *const names[AEAD_NUM_CIPHERS] = {
+  "ascon", "aes", "speck", "present"
+};
+
+const char *aead_name(enum aead_cipher cipher) {
+  return cipher < AEAD_NUM_CIPHERS ? names[cipher] : "?";
+}
+
+int aead_from_name(const char *name) {
+  for(int i = 0; i < AEAD_NUM_CIPHERS; i++) {
+    if(strcmp(name, names[i]) == 0) return i;
+  }
+  return -1;
+}
+
+const struct block_cipher *aead_block_cipher(enum aead_cipher cipher) {
+  switch(cipher) {
+  case AEAD_AES:     return &block_cipher_aes;
+  case AEAD_SPECK:   return &block_cipher_speck;
+  case AEAD_PRESENT: return &block_cipher_present;
+  default:           return NULL;
+  }
+}
+
+uint8_t aead_tag_max(enum aead_cipher cipher) {
+  const struct block_cipher *bc = aead_block_cipher(cipher);
+  return bc ? bc->block_len : ASCON_128_TAG_LEN;
+}
+
+int aead_tag_ok(enum aead_cipher cipher, uint8_t tag_len) {
+  if(tag_len < AEAD_TAG_MIN || tag_len > aead_tag_max(cipher)) return 0;
+  return cipher == AEAD_ASCON || !(tag_len & 1);
+}
+
+void aead_init(struct aead_ctx *ctx, enum aead_cipher cipher,
+               const uint8_t key[AEAD_KEY_LEN]) {
+  const struct block_cipher *bc = aead_block_cipher(cipher);
+  ctx->cipher = cipher;
+  memcpy(ctx->key, key, AEAD_KEY_LEN);
+  if(bc) {
+    block_cipher_init(&ctx->bc, bc, key);
+  }
+}
+
+int aead_seal(const struct aead_ctx *ctx, const uint8_t *nonce,
+              const uint8_t *ad, size_t ad_len,
+              uint8_t *m, size_t len,
+              uint8_t *tag, uint8_t tag_len) {
+  if(!aead_tag_ok(ctx->cipher, tag_len)) return -1;
+  if(ctx->cipher == AEAD_ASCON) {
+    ascon128_encrypt(ctx->key, nonce, ad, ad_len, m, len, m, tag, tag_len);
+    return 0;
+  }
+  return ccm_star_encrypt(&ctx->bc, nonce, ad, ad_len, m, len, tag, tag_len);
+}
+
+int aead_open(const struct aead_ctx *ctx, const uint8_t *nonce,
+              const uint8_t *ad, size_t ad_len,
+              uint8_t *c, size_t len,
+              const uint8_t *tag, uint8_t tag_len) {
+  /* CCM* would take tag_len 0 as "no tag" and report success */
+  if(!aead_tag_ok(ctx->cipher, tag_len)) return -1;
+  if(ctx->cipher == AEAD_ASCON) {
+    return ascon128_decrypt(ctx->key, nonce, ad, ad_len, c, len, c,
+                            tag, tag_len);
+  }
+  return ccm_star_decrypt(&ctx->bc, nonce, ad, ad_len, c, len, tag, tag_len);
+}
@@ -0,0 +1,88 @@
+/* aead.h */
+#ifndef AEAD_H
+#define AEAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ascon.h"
+#include "block_cipher.h"
+
+/*
+ * One AEAD interface over all four ciphers: ASCON-128 for ASCON, CCM*
+ * for AES, SPECK and PRESENT. Callers always pass 16 key bytes and
+ * AEAD_NONCE_MAX nonce bytes; each cipher uses the prefix it needs.
+ */
+
+#define AEAD_KEY_LEN   16
+#define AEAD_NONCE_MAX 16
+#define AEAD_TAG_MAX   16
+#define AEAD_TAG_MIN   4
+
+enum aead_cipher {
+  AEAD_ASCON,
+  AEAD_AES,
+  AEAD_SPECK,
+  AEAD_PRESENT,
+  AEAD_NUM_CIPHERS
+};
+
+struct aead_ctx {
+  enum aead_cipher cipher;
+  uint8_t key[AEAD_KEY_LEN];       /* ASCON keys per call */
+  struct block_cipher_ctx bc;      /* expanded key for CCM* */
+};
+
+/* Name used in logs and on command lines ("ascon", "aes", ...) */
+const char *aead_name(enum aead_cipher cipher);
+
+/* Parse a name back; returns -1 if unknown */
+int aead_from_name(const char *name);
+
+/* Largest tag the cipher can produce: 16, or 8 for PRESENT */
+uint8_t aead_tag_max(enum aead_cipher cipher);
+
+/*
+ * Whether seal/open accept tag_len: AEAD_TAG_MIN to aead_tag_max(),
+ * and even for CCM*. CCM*'s own tag_len 0 (no authentication) is not
+ * available through this interface.
+ */
+int aead_tag_ok(enum aead_cipher cipher, uint8_t tag_len);
+
+/* Block descriptor behind a CCM* cipher, NULL for ASCON */
+const struct block_cipher *aead_block_cipher(enum aead_cipher cipher);
+
+/**
+ * aead_init(ctx, cipher, key):
+ *
+ * Bind ctx to cipher and expand key. A ctx whose bc was filled
+ * elsewhere (e.g. from a key cache) can be used with ctx->cipher set.
+ */
+void aead_init(struct aead_ctx *ctx, enum aead_cipher cipher,
+               const uint8_t key[AEAD_KEY_LEN]);
+
+/**
+ * aead_seal(ctx, nonce, ad, ad_len, m, len, tag, tag_len):
+ *
+ * Encrypt m in place and write tag_len tag bytes (ASCON truncates its
+ * 16-byte tag). Returns 0, or -1 if tag_len fails aead_tag_ok() or a
+ * length is not supported by the cipher.
+ */
+int aead_seal(const struct aead_ctx *ctx, const uint8_t *nonce,
+              const uint8_t *ad, size_t ad_len,
+              uint8_t *m, size_t len,
+              uint8_t *tag, uint8_t tag_len);
+
+/**
+ * aead_open(ctx, nonce, ad, ad_len, c, len, tag, tag_len):
+ *
+ * Decrypt c in place and verify tag. Returns 0 if authentic, -1 if
+ * tag_len fails aead_tag_ok() (c is left alone) or the tag does not
+ * match (c is wiped).
+ */
+int aead_open(const struct aead_ctx *ctx, const uint8_t *nonce,
+              const uint8_t *ad, size_t ad_len,
+              uint8_t *c, size_t len,
+              const uint8_t *tag, uint8_t tag_len);
+
+#endif /* AEAD_H */
@@ -0,0 +1,68 @@
+/* block_cipher.h */
+#ifndef BLOCK_CIPHER_H
+#define BLOCK_CIPHER_H
+
+#include <stdint.h>
+
+#include "aes.h"
+#include "speck.h"
+#include "present.h"
+
+/* Largest block handled by the modes (AES and SPECK-128) */
+#define BLOCK_CIPHER_MAX_BLOCKLEN 16
+/* Largest key (AES and SPECK) */
+#define BLOCK_CIPHER_MAX_KEYLEN   16
+
+struct block_cipher_ctx;
+
+/**
+ * Descriptor binding a raw block cipher to the generic modes.
+ *   - name:       short identifier used in benchmark logs
+ *   - block_len:  block size in bytes (8 or 16)
+ *   - key_len:    key size in bytes
+ *   - init:       expand key into ctx
+ *   - encrypt:    encrypt one block in place (byte order as in the spec)
+ */
+struct block_cipher {
+  const char *name;
+  uint8_t block_len;
+  uint8_t key_len;
+  void (*init)(struct block_cipher_ctx *ctx, const uint8_t *key);
+  void (*encrypt)(const struct block_cipher_ctx *ctx, uint8_t *block);
+};
+
+/**
+ * Expanded key of any supported cipher, plus the descriptor it belongs to.
+ */
+struct block_cipher_ctx {
+  const struct block_cipher *cipher;
+  union {
+    struct AES_ctx aes;
+    uint64_t speck[SPECK_ROUNDS];
+    uint64_t present[PRESENT_ROUNDS + 1];
+  } k;
+};
+
+/* AES-128, 16-byte key, 16-byte block */
+extern const struct block_cipher block_cipher_aes;
+/* SPECK-128/128, key and block as two little-endian 64-bit words */
+extern const struct block_cipher block_cipher_speck;
+/* PRESENT-80, 10-byte key, 8-byte block, both big-endian */
+extern const struct block_cipher block_cipher_present;
+
+/**
+ * Bind ctx to cipher and expand key (cipher->key_len bytes).
+ */
+void block_cipher_init(struct block_cipher_ctx *ctx,
+                       const struct block_cipher *cipher,
+                       const uint8_t *key);
+
+/**
+ * Encrypt one block of ctx->cipher->block_len bytes in place.
+ */
+static inline void block_cipher_encrypt(const struct block_cipher_ctx *ctx,
+                                        uint8_t *block) {
+  ctx->cipher->encrypt(ctx, block);
+}
+
+#endif /* BLOCK_CIPHER_H */
@@ -0,0 +1,162 @@
+/* ccm_star.c */
+#include "ccm_star.h"
+#include "rtprof.h"
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Internal helpers (static)                                         */
+/* ------------------------------------------------------------------ */
+
+/* Running CBC-MAC: x is the chaining block, pos the fill level */
+struct cbc_mac {
+  uint8_t x[BLOCK_CIPHER_MAX_BLOCKLEN];
+  uint8_t pos;
+};
+
+static void mac_update(const struct block_cipher_ctx *ctx,
+                       struct cbc_mac *mac,
+                       const uint8_t *data, size_t len) {
+  uint8_t bl = ctx->cipher->block_len;
+  for(size_t i = 0; i < len; i++) {
+    mac->x[mac->pos++] ^= data[i];
+    if(mac->pos == bl) {
+      block_cipher_encrypt(ctx, mac->x);
+      mac->pos = 0;
+    }
+  }
+}
+
+/* zero-pad the current block (if any) and chain it */
+static void mac_pad(const struct block_cipher_ctx *ctx, struct cbc_mac *mac) {
+  if(mac->pos) {
+    block_cipher_encrypt(ctx, mac->x);
+    mac->pos = 0;
+  }
+}
+
+/* flags || nonce || counter, with the counter in the last L bytes */
+static void format_block(uint8_t *b, uint8_t bl, uint8_t flags,
+                         const uint8_t *nonce, size_t counter) {
+  b[0] = flags;
+  memcpy(b + 1, nonce, CCM_STAR_NONCE_LEN(bl));
+  for(int i = bl - 1; i > bl - 1 - CCM_STAR_L; i--) {
+    b[i] = counter & 0xFF;
+    counter >>= 8;
+  }
+}
+
+static int params_ok(uint8_t bl, size_t m_len, uint8_t tag_len) {
+  if(m_len >> (8 * CCM_STAR_L)) return 0;
+  if(tag_len == 0) return 1;
+  return tag_len >= 4 && tag_len <= bl && !(tag_len & 1);
+}
+
+/* CBC-MAC over B0 || encoded a_len || a || m, result in mac->x */
+static void authenticate(const struct block_cipher_ctx *ctx,
+                         struct cbc_mac *mac, const uint8_t *nonce,
+                         const uint8_t *a, size_t a_len,
+                         const uint8_t *m, size_t m_len, uint8_t tag_len) {
+  uint8_t bl = ctx->cipher->block_len;
+  uint8_t flags = (CCM_STAR_L - 1)
+                | (tag_len ? ((tag_len - 2) / 2) << 3 : 0)
+                | (a_len ? 0x40 : 0);
+
+  RTPROF_BEGIN(RTPROF_CCM_MAC);
+  memset(mac, 0, sizeof(*mac));
+  format_block(mac->x, bl, flags, nonce, m_len);
+  block_cipher_encrypt(ctx, mac->x);
+
+  if(a_len) {
+    uint8_t enc[6];
+    uint8_t n;
+    if(a_len < 0xFF00) {
+      enc[0] = a_len >> 8;  enc[1] = a_len;
+      n = 2;
+    } else {
+      enc[0] = 0xFF;  enc[1] = 0xFE;
+      enc[2] = (uint32_t)a_len >> 24;  enc[3] = (uint32_t)a_len >> 16;
+      enc[4] = (uint32_t)a_len >> 8;   enc[5] = (uint32_t)a_len;
+      n = 6;
+    }
+    mac_update(ctx, mac, enc, n);
+    mac_update(ctx, mac, a, a_len);
+    mac_pad(ctx, mac);
+  }
+  mac_update(ctx, mac, m, m_len);
+  mac_pad(ctx, mac);
+  RTPROF_END(RTPROF_CCM_MAC);
+}
+
+/* CTR keystream: blocks A1, A2, ... xored into buf */
+static void ctr_xcrypt(const struct block_cipher_ctx *ctx,
+                       const uint8_t *nonce, uint8_t *buf, size_t len) {
+  uint8_t bl = ctx->cipher->block_len;
+  uint8_t s[BLOCK_CIPHER_MAX_BLOCKLEN];
+  size_t counter = 1;
+
+  RTPROF_BEGIN(RTPROF_CCM_CTR);
+  for(size_t off = 0; off < len; off += bl) {
+    format_block(s, bl, CCM_STAR_L - 1, nonce, counter++);
+    block_cipher_encrypt(ctx, s);
+    for(size_t i = 0; i < bl && off + i < len; i++) buf[off + i] ^= s[i];
+  }
+  RTPROF_END(RTPROF_CCM_CTR);
+}
+
+/* S0 = E(A0), used to encrypt the tag */
+static void tag_mask(const struct block_cipher_ctx *ctx,
+                     const uint8_t *nonce, uint8_t *s0) {
+  format_block(s0, ctx->cipher->block_len, CCM_STAR_L - 1, nonce, 0);
+  block_cipher_encrypt(ctx, s0);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API implementations                                        */
+/* ------------------------------------------------------------------ */
+
+int ccm_star_encrypt(const struct block_cipher_ctx *ctx,
+                     const uint8_t *nonce,
+                     const uint8_t *a, size_t a_len,
+                     uint8_t *m, size_t m_len,
+                     uint8_t *tag, uint8_t tag_len) {
+  struct cbc_mac mac;
+  uint8_t s0[BLOCK_CIPHER_MAX_BLOCKLEN];
+
+  if(!params_ok(ctx->cipher->block_len, m_len, tag_len)) return -1;
+
+  RTPROF_BEGIN(RTPROF_CCM);
+  if(tag_len) {
+    authenticate(ctx, &mac, nonce, a, a_len, m, m_len, tag_len);
+    tag_mask(ctx, nonce, s0);
+    for(uint8_t i = 0; i < tag_len; i++) tag[i] = mac.x[i] ^ s0[i];
+  }
+  ctr_xcrypt(ctx, nonce, m, m_len);
+  RTPROF_END(RTPROF_CCM);
+  return 0;
+}
+
+int ccm_star_decrypt(const struct block_cipher_ctx *ctx,
+                     const uint8_t *nonce,
+                     const uint8_t *a, size_t a_len,
+                     uint8_t *c, size_t c_len,
+                     const uint8_t *tag, uint8_t tag_len) {
+  struct cbc_mac mac;
+  uint8_t s0[BLOCK_CIPHER_MAX_BLOCKLEN];
+  uint8_t diff = 0;
+
+  if(!params_ok(ctx->cipher->block_len, c_len, tag_len)) return -1;
+
+  RTPROF_BEGIN(RTPROF_CCM);
+  ctr_xcrypt(ctx, nonce, c, c_len);
+  if(tag_len) {
+    authenticate(ctx, &mac, nonce, a, a_len, c, c_len, tag_len);
+    tag_mask(ctx, nonce, s0);
+    /* constant-time compare */
+    for(uint8_t i = 0; i < tag_len; i++) diff |= mac.x[i] ^ s0[i] ^ tag[i];
+    if(diff) {
+      memset(c, 0, c_len);
+    }
+  }
+  RTPROF_END(RTPROF_CCM);
+  return diff ? -1 : 0;
+}
@@ -0,0 +1,48 @@
+/* ccm_star.h */
+#ifndef CCM_STAR_H
+#define CCM_STAR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "block_cipher.h"
+
+/* Size of the length field: messages up to 64 KiB, as in IEEE 802.15.4 */
+#define CCM_STAR_L 2
+
+/* Nonce length for a given block size: 13 bytes for AES, 5 for PRESENT */
+#define CCM_STAR_NONCE_LEN(block_len) ((block_len) - 1 - CCM_STAR_L)
+
+/**
+ * ccm_star_encrypt(ctx, nonce, a, a_len, m, m_len, tag, tag_len):
+ *   - ctx:      expanded key (AES for 802.15.4, or any block_cipher)
+ *   - nonce:    CCM_STAR_NONCE_LEN(block_len) bytes
+ *   - a:        associated data, authenticated only
+ *   - m:        payload, encrypted in place
+ *   - tag:      output, tag_len bytes
+ *   - tag_len:  0 (encryption only) or an even value 4..block_len
+ *
+ * CCM* (CTR encryption + CBC-MAC) over the block cipher bound to ctx.
+ * With AES-128 and a 13-byte nonce this is the 802.15.4 link-layer mode;
+ * with SPECK or PRESENT it is the same construction at their block size.
+ * Returns 0, or -1 if a length parameter is out of range.
+ */
+int ccm_star_encrypt(const struct block_cipher_ctx *ctx,
+                     const uint8_t *nonce,
+                     const uint8_t *a, size_t a_len,
+                     uint8_t *m, size_t m_len,
+                     uint8_t *tag, uint8_t tag_len);
+
+/**
+ * ccm_star_decrypt(ctx, nonce, a, a_len, c, c_len, tag, tag_len):
+ *
+ * Decrypts c in place and verifies tag. Returns 0 if the tag matches,
+ * -1 otherwise; on failure the plaintext is wiped.
+ */
+int ccm_star_decrypt(const struct block_cipher_ctx *ctx,
+                     const uint8_t *nonce,
+                     const uint8_t *a, size_t a_len,
+                     uint8_t *c, size_t c_len,
+                     const uint8_t *tag, uint8_t tag_len);
+
+#endif /* CCM_STAR_H */
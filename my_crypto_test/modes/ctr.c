@@ -0,0 +1,20 @@
+/* ctr.c */
+#include "ctr.h"
+#include <string.h>
+
+void ctr_xor(const struct block_cipher_ctx *ctx, uint8_t *counter,
+             uint8_t *buf, size_t len) {
+  uint8_t bl = ctx->cipher->block_len;
+  uint8_t ks[BLOCK_CIPHER_MAX_BLOCKLEN];
+
+  while(len) {
+    size_t n = len < bl ? len : bl;
+    memcpy(ks, counter, bl);
+    block_cipher_encrypt(ctx, ks);
+    for(size_t i = 0; i < n; i++) buf[i] ^= ks[i];
+    for(int i = bl - 1; i >= 0 && ++counter[i] == 0; i--)
+      ;
+    buf += n;
+    len -= n;
+  }
+}
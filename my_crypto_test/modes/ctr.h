@@ -0,0 +1,24 @@
+/* ctr.h */
+#ifndef CTR_H
+#define CTR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "block_cipher.h"
+
+/**
+ * ctr_xor(ctx, counter, buf, len):
+ *   - ctx:      expanded key
+ *   - counter:  block_len-byte big-endian counter block, advanced in place
+ *   - buf:      data, encrypted or decrypted in place
+ *   - len:      byte count; every call but the last must pass a multiple
+ *               of the block length so the keystream stays aligned
+ *
+ * Plain CTR mode over any block_cipher. No authentication: callers
+ * that need integrity use CCM* (ccm_star.h) instead.
+ */
+void ctr_xor(const struct block_cipher_ctx *ctx, uint8_t *counter,
+             uint8_t *buf, size_t len);
+
+#endif /* CTR_H */
@@ -0,0 +1,266 @@
+/*
+ * my_crypto_net.c
+ * Encrypted sensor traffic over RPL/UDP with per-node Energest reports
+ *
+ * Node SINK_ID is the RPL root and opens every packet it receives; all
+ * other nodes seal a NET_PAYLOAD_LEN-byte reading every SEND_INTERVAL
+ * and send it to the root. The cipher is fixed at build time so each
+ * firmware only links the one it measures:
+ *
+ *   make TARGET=sky my_crypto_net CIPHER=speck PAYLOAD=64
+ *
+ * Packet: seq (4 BE) | node (2 BE) | ciphertext | tag (NET_TAG_LEN).
+ * The first 6 bytes are the associated data; the nonce is seq followed
+ * by the node ID, as in storage/enc_log.
+ *
+ * Every REPORT_INTERVAL each node logs an Energest block in the format
+ * of my_crypto_test.c, covering the whole interval (radio and routing
+ * included), plus the rtimer ticks spent in the AEAD itself.
+ */
+
+#include "contiki.h"
+#include "net/routing/routing.h"
+#include "net/netstack.h"
+#include "net/ipv6/simple-udp.h"
+#include "sys/node-id.h"
+#include "sys/energest.h"
+#include "sys/rtimer.h"
+#include "sys/log.h"
+#include "lib/random.h"
+#include <string.h>
+#include <inttypes.h>
+
+#include "ascon/ascon.h"
+#include "modes/ccm_star.h"
+#include "report/record.h"
+
+#define LOG_MODULE "CryptoNet"
+#define LOG_LEVEL   LOG_LEVEL_INFO
+
+#define NET_ASCON   0
+#define NET_AES     1
+#define NET_SPECK   2
+#define NET_PRESENT 3
+
+#ifndef NET_CIPHER
+#define NET_CIPHER NET_AES
+#endif
+#ifndef NET_PAYLOAD_LEN
+#define NET_PAYLOAD_LEN 32
+#endif
+#define NET_TAG_LEN     8
+#define NET_HDR_LEN     6
+
+#define SINK_ID         1
+#define UDP_PORT        5678
+#define SEND_INTERVAL   (10 * CLOCK_SECOND)
+#define REPORT_INTERVAL (60 * CLOCK_SECOND)
+
+#if NET_CIPHER == NET_ASCON
+#define CIPHER_NAME "ascon"
+#elif NET_CIPHER == NET_AES
+#define CIPHER_NAME "aes"
+#define CIPHER_DESC block_cipher_aes
+#elif NET_CIPHER == NET_SPECK
+#define CIPHER_NAME "speck"
+#define CIPHER_DESC block_cipher_speck
+#elif NET_CIPHER == NET_PRESENT
+#define CIPHER_NAME "present"
+#define CIPHER_DESC block_cipher_present
+#else
+#error "NET_CIPHER must be NET_ASCON, NET_AES, NET_SPECK or NET_PRESENT"
+#endif
+
+/* same network key as the AEAD workloads in my_crypto_test.c */
+static const uint8_t net_key[16] = {
+  0xC0,0xC1,0xC2,0xC3,0xC4,0xC5,0xC6,0xC7,
+  0xC8,0xC9,0xCA,0xCB,0xCC,0xCD,0xCE,0xCF
+};
+#ifdef CIPHER_DESC
+static struct block_cipher_ctx net_ctx;
+#endif
+
+static struct simple_udp_connection udp_conn;
+static uint8_t pkt[NET_HDR_LEN + NET_PAYLOAD_LEN + NET_TAG_LEN];
+static uint32_t tx_seq;
+
+/* per-interval counters */
+static unsigned packets;
+static unsigned long bytes;
+static unsigned long aead_ticks;
+
+PROCESS(my_crypto_net_process, "Crypto + RPL/UDP");
+AUTOSTART_PROCESSES(&my_crypto_net_process);
+
+/* ------------------------------------------------------------------ */
+/*  Internal helpers (static)                                         */
+/* ------------------------------------------------------------------ */
+
+/* seq || node || 0..., for all ciphers (PRESENT reads the first 5) */
+static void make_nonce(const uint8_t *hdr, uint8_t nonce[16]) {
+  memset(nonce, 0, 16);
+  memcpy(nonce, hdr, 4);
+  nonce[4] = hdr[5];
+  nonce[5] = hdr[4];
+}
+
+static void seal_packet(uint8_t *p) {
+  uint8_t nonce[16];
+  rtimer_clock_t t0 = RTIMER_NOW();
+
+  make_nonce(p, nonce);
+#if NET_CIPHER == NET_ASCON
+  ascon128_encrypt(net_key, nonce, p, NET_HDR_LEN,
+                   p + NET_HDR_LEN, NET_PAYLOAD_LEN, p + NET_HDR_LEN,
+                   p + NET_HDR_LEN + NET_PAYLOAD_LEN, NET_TAG_LEN);
+#else
+  ccm_star_encrypt(&net_ctx, nonce, p, NET_HDR_LEN,
+                   p + NET_HDR_LEN, NET_PAYLOAD_LEN,
+                   p + NET_HDR_LEN + NET_PAYLOAD_LEN, NET_TAG_LEN);
+#endif
+  aead_ticks += (rtimer_clock_t)(RTIMER_NOW() - t0);
+}
+
+static int open_packet(uint8_t *p) {
+  uint8_t nonce[16];
+  rtimer_clock_t t0 = RTIMER_NOW();
+  int rc;
+
+  make_nonce(p, nonce);
+#if NET_CIPHER == NET_ASCON
+  rc = ascon128_decrypt(net_key, nonce, p, NET_HDR_LEN,
+                        p + NET_HDR_LEN, NET_PAYLOAD_LEN, p + NET_HDR_LEN,
+                        p + NET_HDR_LEN + NET_PAYLOAD_LEN, NET_TAG_LEN);
+#else
+  rc = ccm_star_decrypt(&net_ctx, nonce, p, NET_HDR_LEN,
+                        p + NET_HDR_LEN, NET_PAYLOAD_LEN,
+                        p + NET_HDR_LEN + NET_PAYLOAD_LEN, NET_TAG_LEN);
+#endif
+  aead_ticks += (rtimer_clock_t)(RTIMER_NOW() - t0);
+  return rc;
+}
+
+static void udp_rx_callback(struct simple_udp_connection *c,
+                            const uip_ipaddr_t *sender_addr,
+                            uint16_t sender_port,
+                            const uip_ipaddr_t *receiver_addr,
+                            uint16_t receiver_port,
+                            const uint8_t *data,
+                            uint16_t datalen) {
+  if(datalen != sizeof(pkt)) {
+    LOG_WARN("dropped %u-byte packet\n", datalen);
+    return;
+  }
+  memcpy(pkt, data, sizeof(pkt));
+  if(open_packet(pkt) < 0) {
+    LOG_WARN("authentication failed from node %u\n",
+             (unsigned)(pkt[4] << 8 | pkt[5]));
+    return;
+  }
+  packets++;
+  bytes += NET_PAYLOAD_LEN;
+}
+
+static void send_reading(void) {
+  uip_ipaddr_t dest;
+
+  if(!NETSTACK_ROUTING.node_is_reachable() ||
+     !NETSTACK_ROUTING.get_root_ipaddr(&dest)) {
+    return;
+  }
+  pkt[0] = tx_seq >> 24;  pkt[1] = tx_seq >> 16;
+  pkt[2] = tx_seq >> 8;   pkt[3] = tx_seq;
+  pkt[4] = node_id >> 8;  pkt[5] = node_id;
+  /* stand-in reading */
+  for(unsigned i = 0; i < NET_PAYLOAD_LEN; i++) {
+    pkt[NET_HDR_LEN + i] = (uint8_t)(tx_seq + i);
+  }
+  seal_packet(pkt);
+  simple_udp_sendto(&udp_conn, pkt, sizeof(pkt), &dest);
+  tx_seq++;
+  packets++;
+  bytes += NET_PAYLOAD_LEN;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Process                                                           */
+/* ------------------------------------------------------------------ */
+
+PROCESS_THREAD(my_crypto_net_process, ev, data)
+{
+  static struct etimer send_timer, report_timer;
+  static uint64_t cpu_b, lpm_b, tx_b, rx_b;
+  static unsigned round;
+  uint64_t cpu_a, lpm_a, tx_a, rx_a;
+  struct record rec;
+
+  PROCESS_BEGIN();
+
+#ifdef CIPHER_DESC
+  block_cipher_init(&net_ctx, &CIPHER_DESC, net_key);
+#endif
+  if(node_id == SINK_ID) {
+    NETSTACK_ROUTING.root_start();
+  }
+  simple_udp_register(&udp_conn, UDP_PORT, NULL, UDP_PORT, udp_rx_callback);
+
+  energest_flush();
+  cpu_b = energest_type_time(ENERGEST_TYPE_CPU);
+  lpm_b = energest_type_time(ENERGEST_TYPE_LPM);
+  tx_b  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+  rx_b  = energest_type_time(ENERGEST_TYPE_LISTEN);
+
+  etimer_set(&send_timer, random_rand() % SEND_INTERVAL);
+  etimer_set(&report_timer, REPORT_INTERVAL);
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER);
+
+    if(data == &send_timer) {
+      if(node_id != SINK_ID) {
+        send_reading();
+      }
+      /* jitter so neighbours do not transmit in lockstep */
+      etimer_set(&send_timer, SEND_INTERVAL - SEND_INTERVAL / 8
+                 + random_rand() % (SEND_INTERVAL / 4));
+    } else if(data == &report_timer) {
+      etimer_reset(&report_timer);
+
+      energest_flush();
+      cpu_a = energest_type_time(ENERGEST_TYPE_CPU);
+      lpm_a = energest_type_time(ENERGEST_TYPE_LPM);
+      tx_a  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+      rx_a  = energest_type_time(ENERGEST_TYPE_LISTEN);
+
+      LOG_INFO("----- Energest in last %lus -----\n",
+               (unsigned long)(REPORT_INTERVAL / CLOCK_SECOND));
+      LOG_INFO(" Workload  : %s-net-%s x%u\n", CIPHER_NAME,
+               node_id == SINK_ID ? "rx" : "tx", packets);
+      LOG_INFO(" Bytes     : %lu\n", bytes);
+      LOG_INFO(" CPU ticks : %" PRIu64 "\n", cpu_a - cpu_b);
+      LOG_INFO(" LPM ticks : %" PRIu64 "\n", lpm_a - lpm_b);
+      LOG_INFO(" TX ticks  : %" PRIu64 "\n", tx_a  - tx_b);
+      LOG_INFO(" RX ticks  : %" PRIu64 "\n", rx_a  - rx_b);
+      LOG_INFO(" AEAD ticks: %lu\n", aead_ticks);
+
+      rec.workload = node_id == SINK_ID ? CIPHER_NAME "-net-rx"
+                                        : CIPHER_NAME "-net-tx";
+      rec.payload  = NET_PAYLOAD_LEN;
+      rec.iter     = packets;
+      rec.round    = ++round;
+      rec.cpu = cpu_a - cpu_b;
+      rec.lpm = lpm_a - lpm_b;
+      rec.tx  = tx_a  - tx_b;
+      rec.rx  = rx_a  - rx_b;
+      rec.aead = aead_ticks;
+      record_log(&rec);
+
+      cpu_b = cpu_a;  lpm_b = lpm_a;  tx_b = tx_a;  rx_b = rx_a;
+      packets = 0;
+      bytes = 0;
+      aead_ticks = 0;
+    }
+  }
+
+  PROCESS_END();
+}
@@ -15,12 +15,18 @@
  #include "speck/speck.h"
  #include "present/present.h"
  #include "tinyaes/aes.h"
+ #include "modes/ccm_star.h"
+ #include "storage/enc_log.h"
+ #include "prof/rtprof.h"
+ #include "report/record.h"
  
  #define LOG_MODULE "CryptoTest"
  #define LOG_LEVEL   LOG_LEVEL_INFO
  
  #define TEST_INTERVAL (1 * CLOCK_SECOND)
+ #ifndef ITER
  #define ITER           1000
+ #endif
  #define BLOCKS           1
  
  /* --- ASCON buffers --- */
@@ -59,17 +65,203 @@
  static uint8_t aes_buf[16];
  static struct AES_ctx aes_ctx;
  
+ /* --- AEAD buffers: same key, nonce, AD and payload for every cipher --- */
+ /* make PAYLOAD=n sets the payload length */
+ #ifndef AEAD_PAYLOAD_LEN
+ #define AEAD_PAYLOAD_LEN 32
+ #endif
+ #define AEAD_AD_LEN       8
+ #define AEAD_TAG_LEN      8
+ 
+ static const uint8_t aead_key[16] = {
+   0xC0,0xC1,0xC2,0xC3,0xC4,0xC5,0xC6,0xC7,
+   0xC8,0xC9,0xCA,0xCB,0xCC,0xCD,0xCE,0xCF
+ };
+ /* ASCON-128 reads all 16 bytes, CCM* the first 13 (PRESENT: 5) */
+ static const uint8_t aead_nonce[16] = {
+   0x00,0x00,0x00,0x03,0x02,0x01,0x00,0xA0,0xA1,0xA2,0xA3,0xA4,0xA5
+ };
+ static const uint8_t aead_ad[AEAD_AD_LEN] = {
+   0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07
+ };
+ static uint8_t aead_buf[AEAD_PAYLOAD_LEN];
+ static uint8_t aead_tag[AEAD_TAG_LEN];
+ static struct block_cipher_ctx aead_ctx;
+ /* filled with 00 01 02 ... at start-up */
+ static uint8_t aead_pt[AEAD_PAYLOAD_LEN];
+ 
+ /* --- Image verification: an image streamed one flash page at a time --- */
+ #define IMAGE_PAGE_LEN  256
+ #define IMAGE_PAGES       8
+ #ifndef IMAGE_ITER
+ #define IMAGE_ITER       10
+ #endif
+ 
+ static uint8_t image_page[IMAGE_PAGE_LEN];
+ static uint8_t image_digest[ASCON_HASH_LEN];
+ static ascon_hash_ctx hash_ctx;
+ 
+ /* stands in for reading page p from external flash */
+ static uint8_t *read_image_page(unsigned p) {
+   memset(image_page, (uint8_t)p, sizeof(image_page));
+   return image_page;
+ }
+ 
+ /* --- Encrypted logging: sensor records appended to a Coffee file --- */
+ #define LOG_RECORD_LEN  16
+ #define LOG_RECORDS     64
+ #ifndef LOG_ITER
+ #define LOG_ITER         5
+ #endif
+ #define LOG_FILE        "enclog"
+ 
+ static struct enc_log enc_log;
+ static uint8_t log_record[LOG_RECORD_LEN];
+ 
+ /* ------------------------------------------------------------------ */
+ /*  Workloads: one call = one iteration, measured ITER times each     */
+ /* ------------------------------------------------------------------ */
+ 
+ static void run_ascon(void) {
+   memset(ascon_state, 0, sizeof(ascon_state));
+   ascon_initialization(ascon_state, ascon_key);
+   ascon_encrypt(ascon_state, ascon_pt, ascon_ct, BLOCKS);
+   ascon_finalization(ascon_state, ascon_key);
+ }
+ 
+ static void run_speck(void) {
+   speck_encrypt(speck_pt, speck_ct, speck_key);
+ }
+ 
+ static void run_present(void) {
+   char *ct_hex = present_encrypt(present_pt_hex, present_key_hex);
+   if(ct_hex) {
+     free(ct_hex);
+   }
+ }
+ 
+ static void run_aes(void) {
+   memcpy(aes_buf, aes_pt, sizeof(aes_buf));
+   AES_init_ctx(&aes_ctx, aes_key);
+   AES_ECB_encrypt(&aes_ctx, aes_buf);
+ }
+ 
+ static void run_ascon_aead(void) {
+   ascon128_encrypt(aead_key, aead_nonce, aead_ad, AEAD_AD_LEN,
+                    aead_pt, AEAD_PAYLOAD_LEN, aead_buf,
+                    aead_tag, AEAD_TAG_LEN);
+ }
+ 
+ /* key setup + CCM* over the same payload, as a per-packet cost */
+ static void run_ccm_star(const struct block_cipher *cipher) {
+   memcpy(aead_buf, aead_pt, sizeof(aead_buf));
+   block_cipher_init(&aead_ctx, cipher, aead_key);
+   ccm_star_encrypt(&aead_ctx, aead_nonce, aead_ad, AEAD_AD_LEN,
+                    aead_buf, AEAD_PAYLOAD_LEN, aead_tag, AEAD_TAG_LEN);
+ }
+ 
+ static void run_aes_ccm(void)     { run_ccm_star(&block_cipher_aes); }
+ static void run_speck_ccm(void)   { run_ccm_star(&block_cipher_speck); }
+ static void run_present_ccm(void) { run_ccm_star(&block_cipher_present); }
+ 
+ static void run_ascon_hash(void) {
+   ascon_hash_init(&hash_ctx);
+   for(unsigned p = 0; p < IMAGE_PAGES; p++) {
+     ascon_hash_update(&hash_ctx, read_image_page(p), IMAGE_PAGE_LEN);
+   }
+   ascon_hash_final(&hash_ctx, image_digest);
+ }
+ 
+ static void run_ascon_mac(void) {
+   ascon_mac_init(&hash_ctx, aead_key);
+   for(unsigned p = 0; p < IMAGE_PAGES; p++) {
+     ascon_hash_update(&hash_ctx, read_image_page(p), IMAGE_PAGE_LEN);
+   }
+   ascon_mac_final(&hash_ctx, image_digest);
+ }
+ 
+ /* CBC-MAC: CBC-encrypt each page in place, the chained IV is the tag */
+ static void run_aes_cbc_mac(void) {
+   static const uint8_t zero_iv[AES_BLOCKLEN];
+   AES_init_ctx_iv(&aes_ctx, aead_key, zero_iv);
+   for(unsigned p = 0; p < IMAGE_PAGES; p++) {
+     AES_CBC_encrypt_buffer(&aes_ctx, read_image_page(p),
+                            IMAGE_PAGE_LEN);
+   }
+   memcpy(image_digest, aes_ctx.Iv, AES_BLOCKLEN);
+ }
+ 
+ /* append LOG_RECORDS records, then read them back and verify */
+ static void run_enc_log(enum enc_log_cipher cipher) {
+   enc_log_create(&enc_log, LOG_FILE, cipher, aead_key, 1,
+                  LOG_RECORDS * LOG_RECORD_LEN * 2);
+   for(unsigned r = 0; r < LOG_RECORDS; r++) {
+     memset(log_record, (uint8_t)r, sizeof(log_record));
+     enc_log_append(&enc_log, log_record, sizeof(log_record));
+   }
+   enc_log_close(&enc_log);
+ 
+   enc_log_open(&enc_log, LOG_FILE, cipher, aead_key, 1);
+   for(unsigned r = 0; r < LOG_RECORDS; r++) {
+     if(enc_log_read(&enc_log, log_record, sizeof(log_record))
+        != sizeof(log_record) || log_record[0] != (uint8_t)r) {
+       LOG_ERR("encrypted log read-back failed at record %u\n", r);
+       break;
+     }
+   }
+   enc_log_close(&enc_log);
+ }
+ 
+ static void run_ascon_log(void)   { run_enc_log(ENC_LOG_ASCON); }
+ static void run_aes_log(void)     { run_enc_log(ENC_LOG_AES); }
+ static void run_speck_log(void)   { run_enc_log(ENC_LOG_SPECK); }
+ static void run_present_log(void) { run_enc_log(ENC_LOG_PRESENT); }
+ 
+ static const struct {
+   const char *name;
+   void (*run)(void);
+   unsigned iter;
+   unsigned long bytes;   /* payload bytes handled per iteration */
+ } workloads[] = {
+   /* raw single-block encryption */
+   { "ascon",        run_ascon,       ITER,       8 * BLOCKS },
+   { "speck",        run_speck,       ITER,       16 },
+   { "present",      run_present,     ITER,       8 },
+   { "aes",          run_aes,         ITER,       16 },
+   /* authenticated encryption, AEAD_PAYLOAD_LEN/AEAD_AD_LEN/AEAD_TAG_LEN */
+   { "ascon-aead",   run_ascon_aead,  ITER,       AEAD_PAYLOAD_LEN },
+   { "aes-ccm*",     run_aes_ccm,     ITER,       AEAD_PAYLOAD_LEN },
+   { "speck-ccm*",   run_speck_ccm,   ITER,       AEAD_PAYLOAD_LEN },
+   { "present-ccm*", run_present_ccm, ITER,       AEAD_PAYLOAD_LEN },
+   /* image verification, IMAGE_PAGES x IMAGE_PAGE_LEN bytes */
+   { "ascon-hash",   run_ascon_hash,  IMAGE_ITER, IMAGE_PAGES * IMAGE_PAGE_LEN },
+   { "ascon-mac",    run_ascon_mac,   IMAGE_ITER, IMAGE_PAGES * IMAGE_PAGE_LEN },
+   { "aes-cbc-mac",  run_aes_cbc_mac, IMAGE_ITER, IMAGE_PAGES * IMAGE_PAGE_LEN },
+   /* encrypted storage incl. flash writes and read-back */
+   { "ascon-log",    run_ascon_log,   LOG_ITER,   LOG_RECORDS * LOG_RECORD_LEN },
+   { "aes-log",      run_aes_log,     LOG_ITER,   LOG_RECORDS * LOG_RECORD_LEN },
+   { "speck-log",    run_speck_log,   LOG_ITER,   LOG_RECORDS * LOG_RECORD_LEN },
+   { "present-log",  run_present_log, LOG_ITER,   LOG_RECORDS * LOG_RECORD_LEN },
+ };
+ #define NUM_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+ 
  PROCESS(my_crypto_test_process, "Crypto + Energest");
  AUTOSTART_PROCESSES(&my_crypto_test_process);
  
  PROCESS_THREAD(my_crypto_test_process, ev, data)
  {
    static struct etimer timer;
+   static unsigned round;
+   struct record rec;
    uint64_t cpu_b, lpm_b, tx_b, rx_b;
    uint64_t cpu_a, lpm_a, tx_a, rx_a;
  
    PROCESS_BEGIN();
  
+   for(unsigned i = 0; i < AEAD_PAYLOAD_LEN; i++) {
+     aead_pt[i] = i;
+   }
+ 
    /* Initialize Energest */
    energest_init();
    etimer_set(&timer, TEST_INTERVAL);
@@ -77,53 +269,58 @@
    while(1) {
      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_TIMER && data == &timer);
      etimer_reset(&timer);
+     round++;
+ 
+     LOG_INFO("----- Energest in last %lus -----\n",
+              (unsigned long)(TEST_INTERVAL / CLOCK_SECOND));
+     LOG_INFO(" Ticks/s   : %lu\n", (unsigned long)ENERGEST_SECOND);
  
-     /* snapshot before */
-     energest_flush();
-     cpu_b = energest_type_time(ENERGEST_TYPE_CPU);
-     lpm_b = energest_type_time(ENERGEST_TYPE_LPM);
-     tx_b  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
-     rx_b  = energest_type_time(ENERGEST_TYPE_LISTEN);
- 
-     /* crypto workload */
-     for(int i = 0; i < ITER; i++) {
-       /* ASCON */
-       memset(ascon_state, 0, sizeof(ascon_state));
-       ascon_initialization(ascon_state, ascon_key);
-       ascon_encrypt(ascon_state, ascon_pt, ascon_ct, BLOCKS);
-       ascon_finalization(ascon_state, ascon_key);
- 
-       /* SPECK */
-       speck_encrypt(speck_pt, speck_ct, speck_key);
- 
-       /* PRESENT */
-       {
-         char *ct_hex = present_encrypt(present_pt_hex, present_key_hex);
-         if(ct_hex) {
-           free(ct_hex);
-         }
+     for(unsigned w = 0; w < NUM_WORKLOADS; w++) {
+       /* snapshot before */
+       energest_flush();
+       cpu_b = energest_type_time(ENERGEST_TYPE_CPU);
+       lpm_b = energest_type_time(ENERGEST_TYPE_LPM);
+       tx_b  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+       rx_b  = energest_type_time(ENERGEST_TYPE_LISTEN);
+       rtprof_reset();
+ 
+       /* crypto workload */
+       for(unsigned i = 0; i < workloads[w].iter; i++) {
+         workloads[w].run();
        }
  
-       /* AES-128 ECB */
-       memcpy(aes_buf, aes_pt, sizeof(aes_buf));
-       AES_init_ctx(&aes_ctx, aes_key);
-       AES_ECB_encrypt(&aes_ctx, aes_buf);
-     }
+       /* snapshot after */
+       energest_flush();
+       cpu_a = energest_type_time(ENERGEST_TYPE_CPU);
+       lpm_a = energest_type_time(ENERGEST_TYPE_LPM);
+       tx_a  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+       rx_a  = energest_type_time(ENERGEST_TYPE_LISTEN);
  
-     /* snapshot after */
-     energest_flush();
-     cpu_a = energest_type_time(ENERGEST_TYPE_CPU);
-     lpm_a = energest_type_time(ENERGEST_TYPE_LPM);
-     tx_a  = energest_type_time(ENERGEST_TYPE_TRANSMIT);
-     rx_a  = energest_type_time(ENERGEST_TYPE_LISTEN);
+       /* log the deltas */
+       LOG_INFO(" Workload  : %s x%u\n", workloads[w].name, workloads[w].iter);
+       LOG_INFO(" Bytes     : %lu\n", workloads[w].bytes * workloads[w].iter);
+       LOG_INFO(" CPU ticks : %" PRIu64 "\n", cpu_a - cpu_b);
+       LOG_INFO(" LPM ticks : %" PRIu64 "\n", lpm_a - lpm_b);
+       LOG_INFO(" TX ticks  : %" PRIu64 "\n", tx_a  - tx_b);
+       LOG_INFO(" RX ticks  : %" PRIu64 "\n", rx_a  - rx_b);
  
-     /* log the deltas */
-     LOG_INFO("----- Energest in last %lus -----\n",
-              (unsigned long)(TEST_INTERVAL / CLOCK_SECOND));
-     LOG_INFO(" CPU ticks : %" PRIu64 "\n", cpu_a - cpu_b);
-     LOG_INFO(" LPM ticks : %" PRIu64 "\n", lpm_a - lpm_b);
-     LOG_INFO(" TX ticks  : %" PRIu64 "\n", tx_a  - tx_b);
-     LOG_INFO(" RX ticks  : %" PRIu64 "\n", rx_a  - rx_b);
+       rec.workload = workloads[w].name;
+       rec.payload  = workloads[w].bytes;
+       rec.iter     = workloads[w].iter;
+       rec.round    = round;
+       rec.cpu = cpu_a - cpu_b;
+       rec.lpm = lpm_a - lpm_b;
+       rec.tx  = tx_a  - tx_b;
+       rec.rx  = rx_a  - rx_b;
+       rec.aead = RECORD_NO_AEAD;
+       record_log(&rec);
+ 
+       /* region breakdown, only with make PROF=1 */
+       rtprof_summary(workloads[w].name);
+       if(RTPROF_DUMP) {
+         rtprof_dump();
+       }
+     }
    }
  
    PROCESS_END();
@@ -1,6 +1,8 @@
 /* present.c */
 #include "present.h"
+#include "rtprof.h"
 #include <stdio.h>
+#include <inttypes.h>
 #include <string.h>
 
 /* ---- S-box, inverse S-box, permutation table ---- */
@@ -71,12 +73,11 @@ static uint16_t getKeyLow(const char *k) {
   }
   return kl;
 }
-static uint64_t *generateSubkeys(const char *key_hex) {
-  uint64_t *subs = malloc(32 * sizeof(*subs));
-  uint64_t kh = present_fromHexStringToLong(key_hex);
-  uint16_t kl = getKeyLow(key_hex);
+static void expandKey(uint64_t kh, uint16_t kl,
+                      uint64_t subs[PRESENT_ROUNDS + 1]) {
+  RTPROF_BEGIN(RTPROF_PRESENT_KEY);
   subs[0] = kh;
-  for(int i = 1; i < 32; i++) {
+  for(int i = 1; i < PRESENT_ROUNDS + 1; i++) {
     uint64_t th = kh, new_h;
     uint16_t tl = kl;
     /* rotate left 61 */
@@ -91,15 +92,59 @@ static uint64_t *generateSubkeys(const char *key_hex) {
     kh ^= (i >> 1);
     subs[i] = kh;
   }
+  RTPROF_END(RTPROF_PRESENT_KEY);
+}
+static uint64_t *generateSubkeys(const char *key_hex) {
+  uint64_t *subs = malloc((PRESENT_ROUNDS + 1) * sizeof(*subs));
+  expandKey(present_fromHexStringToLong(key_hex), getKeyLow(key_hex), subs);
   return subs;
 }
 
+/* ---- Binary block API (no hex strings, no heap) ---- */
+static uint64_t sBoxLayer(uint64_t s, const uint8_t box[16]) {
+  uint64_t r = 0;
+  for(int i = 0; i < 64; i += 4) {
+    r |= (uint64_t)box[(s >> i) & 0xF] << i;
+  }
+  return r;
+}
+
+void present_key_schedule(const uint8_t key[10],
+                          uint64_t subkeys[PRESENT_ROUNDS + 1]) {
+  uint64_t kh = 0;
+  for(int i = 0; i < 8; i++) {
+    kh = (kh << 8) | key[i];
+  }
+  expandKey(kh, ((uint16_t)key[8] << 8) | key[9], subkeys);
+}
+
+uint64_t present_encrypt_block(uint64_t s,
+                               const uint64_t subkeys[PRESENT_ROUNDS + 1]) {
+  RTPROF_BEGIN(RTPROF_PRESENT_ROUNDS);
+  for(int r = 0; r < PRESENT_ROUNDS; r++) {
+    s = permute(sBoxLayer(s ^ subkeys[r], S));
+  }
+  RTPROF_END(RTPROF_PRESENT_ROUNDS);
+  return s ^ subkeys[PRESENT_ROUNDS];
+}
+
+uint64_t present_decrypt_block(uint64_t s,
+                               const uint64_t subkeys[PRESENT_ROUNDS + 1]) {
+  RTPROF_BEGIN(RTPROF_PRESENT_ROUNDS);
+  for(int r = PRESENT_ROUNDS; r > 0; r--) {
+    s = sBoxLayer(inversepermute(s ^ subkeys[r]), invS);
+  }
+  RTPROF_END(RTPROF_PRESENT_ROUNDS);
+  return s ^ subkeys[0];
+}
+
 /* ---- Public encrypt/decrypt ---- */
 char *present_encrypt(const char *pt_hex, const char *key_hex) {
   uint64_t *sub = generateSubkeys(key_hex);
   uint64_t s = present_fromHexStringToLong(pt_hex);
 
-  for(int r = 0; r < 31; r++) {
+  RTPROF_BEGIN(RTPROF_PRESENT_ROUNDS);
+  for(int r = 0; r < PRESENT_ROUNDS; r++) {
     s ^= sub[r];
     /* S-box layer */
     byte *bs = longToBytes(s);
@@ -115,7 +160,8 @@ char *present_encrypt(const char *pt_hex, const char *key_hex) {
     free(bs);
     s = permute(t);
   }
-  s ^= sub[31];
+  RTPROF_END(RTPROF_PRESENT_ROUNDS);
+  s ^= sub[PRESENT_ROUNDS];
   free(sub);
 
   char *out = malloc(17);
@@ -126,7 +172,8 @@ char *present_decrypt(const char *ct_hex, const char *key_hex) {
   uint64_t *sub = generateSubkeys(key_hex);
   uint64_t s = present_fromHexStringToLong(ct_hex);
 
-  for(int r = 31; r > 0; r--) {
+  RTPROF_BEGIN(RTPROF_PRESENT_ROUNDS);
+  for(int r = PRESENT_ROUNDS; r > 0; r--) {
     s ^= sub[r];
     s = inversepermute(s);
     byte *bs = longToBytes(s);
@@ -142,6 +189,7 @@ char *present_decrypt(const char *ct_hex, const char *key_hex) {
     free(bs);
     s = t;
   }
+  RTPROF_END(RTPROF_PRESENT_ROUNDS);
   s ^= sub[0];
   free(sub);
 
@@ -5,6 +5,9 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/* PRESENT-80: 31 rounds plus a final key whitening, 32 round keys */
+#define PRESENT_ROUNDS 31
+
 /* A packed byte of two 4-bit nibbles */
 typedef struct __attribute__((__packed__)) {
     uint8_t nibble1:4;
@@ -38,4 +41,27 @@ char *present_encrypt(const char *plaintext_hex, const char *key_hex);
  */
 char *present_decrypt(const char *ciphertext_hex, const char *key_hex);
 
+/* ---- Binary block API ---- */
+
+/**
+ * Expand an 80-bit key (10 bytes, most significant first) into the
+ * PRESENT_ROUNDS + 1 round keys used by the block functions below.
+ */
+void present_key_schedule(const uint8_t key[10],
+                          uint64_t subkeys[PRESENT_ROUNDS + 1]);
+
+/**
+ * Encrypt one 64-bit block with an expanded key schedule.
+ * Unlike present_encrypt(), this allocates nothing and does no hex parsing,
+ * so it is the entry point used by the block-cipher modes.
+ */
+uint64_t present_encrypt_block(uint64_t block,
+                               const uint64_t subkeys[PRESENT_ROUNDS + 1]);
+
+/**
+ * Decrypt one 64-bit block with an expanded key schedule.
+ */
+uint64_t present_decrypt_block(uint64_t block,
+                               const uint64_t subkeys[PRESENT_ROUNDS + 1]);
+
 #endif /* PRESENT_H */
@@ -0,0 +1,146 @@
+/* rtprof.c */
+#include "rtprof.h"
+
+#if RTPROF_ENABLED
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "sys/log.h"
+#include <string.h>
+
+#define LOG_MODULE "RtProf"
+#define LOG_LEVEL  LOG_LEVEL_INFO
+
+#if RTPROF_SIZE & (RTPROF_SIZE - 1)
+#error "RTPROF_CONF_SIZE must be a power of two"
+#endif
+
+/* ------------------------------------------------------------------ */
+/*  Internal state (static)                                           */
+/* ------------------------------------------------------------------ */
+
+/* region in the low bits, END_FLAG set on RTPROF_END() */
+#define END_FLAG 0x80
+
+struct event {
+  rtimer_clock_t t;
+  uint8_t ev;
+};
+
+struct stat {
+  uint32_t calls;
+  uint32_t total;       /* inclusive ticks */
+  uint32_t child;       /* ticks of directly enclosed regions */
+  rtimer_clock_t min, max;
+};
+
+struct frame {
+  rtimer_clock_t start;
+  uint8_t region;
+};
+
+static const char *const names[RTPROF_NUM_REGIONS] = {
+  "ascon-perm", "ascon-aead", "ascon-absorb",
+  "aes-key", "aes-rounds", "aes-copy", "aes-cbc",
+  "speck-key", "speck-rounds",
+  "present-key", "present-rounds",
+  "bc-copy",
+  "ccm", "ccm-mac", "ccm-ctr",
+  "log-flash"
+};
+
+static struct event ring[RTPROF_SIZE];
+static uint16_t head;
+static uint8_t wrapped;
+
+static struct stat stats[RTPROF_NUM_REGIONS];
+static struct frame stack[RTPROF_DEPTH];
+static uint8_t depth;          /* may exceed RTPROF_DEPTH */
+static uint16_t dropped;       /* ends not matched to a stored begin */
+
+static void record(rtimer_clock_t t, uint8_t ev) {
+  ring[head].t  = t;
+  ring[head].ev = ev;
+  head = (head + 1) & (RTPROF_SIZE - 1);
+  if(head == 0) {
+    wrapped = 1;
+  }
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API implementations                                        */
+/* ------------------------------------------------------------------ */
+
+void rtprof_begin(enum rtprof_region r) {
+  rtimer_clock_t now = RTIMER_NOW();
+  record(now, r);
+  if(depth < RTPROF_DEPTH) {
+    stack[depth].start  = now;
+    stack[depth].region = r;
+  }
+  depth++;
+}
+
+void rtprof_end(enum rtprof_region r) {
+  rtimer_clock_t now = RTIMER_NOW();
+  rtimer_clock_t d;
+  struct stat *s;
+
+  record(now, r | END_FLAG);
+  if(depth == 0) {
+    dropped++;
+    return;
+  }
+  depth--;
+  if(depth >= RTPROF_DEPTH || stack[depth].region != r) {
+    dropped++;
+    return;
+  }
+
+  d = (rtimer_clock_t)(now - stack[depth].start);
+  s = &stats[r];
+  if(s->calls == 0 || d < s->min) s->min = d;
+  if(d > s->max) s->max = d;
+  s->calls++;
+  s->total += d;
+  if(depth) {
+    stats[stack[depth - 1].region].child += d;
+  }
+}
+
+void rtprof_reset(void) {
+  memset(stats, 0, sizeof(stats));
+  head = 0;
+  wrapped = 0;
+  depth = 0;
+  dropped = 0;
+}
+
+void rtprof_summary(const char *label) {
+  LOG_INFO(" Profile   : %s, %lu ticks/s, %u dropped\n",
+           label, (unsigned long)RTIMER_SECOND, dropped);
+  for(int r = 0; r < RTPROF_NUM_REGIONS; r++) {
+    const struct stat *s = &stats[r];
+    if(s->calls == 0) {
+      continue;
+    }
+    LOG_INFO("  %-14s calls %6lu total %8lu self %8lu min %5lu max %5lu\n",
+             names[r], (unsigned long)s->calls, (unsigned long)s->total,
+             (unsigned long)(s->total - s->child),
+             (unsigned long)s->min, (unsigned long)s->max);
+  }
+}
+
+void rtprof_dump(void) {
+  uint16_t i = wrapped ? head : 0;
+  uint16_t n = wrapped ? RTPROF_SIZE : head;
+
+  LOG_INFO(" Trace     : %u events\n", n);
+  for(; n; n--, i = (i + 1) & (RTPROF_SIZE - 1)) {
+    LOG_INFO("  %lu %c%s\n", (unsigned long)ring[i].t,
+             (ring[i].ev & END_FLAG) ? '-' : '+',
+             names[ring[i].ev & ~END_FLAG]);
+  }
+}
+
+#endif /* RTPROF_ENABLED */
@@ -0,0 +1,104 @@
+/* rtprof.h */
+#ifndef RTPROF_H
+#define RTPROF_H
+
+#include <stdint.h>
+
+/*
+ * On-device region profiler on the rtimer clock.
+ *
+ * RTPROF_BEGIN(r) / RTPROF_END(r) bracket a named region. Each probe
+ * stores RTIMER_NOW() and the region in a ring of RTPROF_SIZE events
+ * and keeps per-region totals (calls, inclusive and self ticks, min,
+ * max), so the summary covers every call while the ring keeps only
+ * the most recent events.
+ *
+ * Probes are compiled out unless the build sets RTPROF_CONF_ENABLED
+ * (make PROF=1), so the cipher sources still build natively for the
+ * gateway tools and default firmware is unchanged. When enabled a
+ * probe is one call and one rtimer read; on sky and z1 a tick is
+ * ~30.5 us, so single short regions read as 0 or 1 tick and only
+ * totals over many calls are meaningful.
+ *
+ * Regions nest (self time excludes enclosed regions) up to
+ * RTPROF_DEPTH levels; a region must not enclose itself.
+ */
+
+#ifdef RTPROF_CONF_ENABLED
+#define RTPROF_ENABLED RTPROF_CONF_ENABLED
+#else
+#define RTPROF_ENABLED 0
+#endif
+
+/* Ring length in events, a power of two */
+#ifdef RTPROF_CONF_SIZE
+#define RTPROF_SIZE RTPROF_CONF_SIZE
+#else
+#define RTPROF_SIZE 128
+#endif
+
+/* Also log the raw ring after each summary (make PROF=dump) */
+#ifdef RTPROF_CONF_DUMP
+#define RTPROF_DUMP RTPROF_CONF_DUMP
+#else
+#define RTPROF_DUMP 0
+#endif
+
+#define RTPROF_DEPTH 8
+
+enum rtprof_region {
+  RTPROF_ASCON_PERM,      /* p_perm(), all round counts */
+  RTPROF_ASCON_AEAD,      /* ascon128_encrypt/decrypt() mode wrapper */
+  RTPROF_ASCON_ABSORB,    /* ascon_hash_update() */
+  RTPROF_AES_KEY,         /* key expansion */
+  RTPROF_AES_ROUNDS,      /* Cipher() */
+  RTPROF_AES_COPY,        /* bytes <-> state matrix */
+  RTPROF_AES_CBC,         /* AES_CBC_encrypt_buffer() */
+  RTPROF_SPECK_KEY,
+  RTPROF_SPECK_ROUNDS,
+  RTPROF_PRESENT_KEY,
+  RTPROF_PRESENT_ROUNDS,
+  RTPROF_BC_COPY,         /* block_cipher byte-order conversion */
+  RTPROF_CCM,             /* ccm_star_encrypt/decrypt() mode wrapper */
+  RTPROF_CCM_MAC,         /* CBC-MAC */
+  RTPROF_CCM_CTR,         /* CTR keystream */
+  RTPROF_LOG_FLASH,       /* enc_log cfs_read/cfs_write */
+  RTPROF_NUM_REGIONS
+};
+
+#if RTPROF_ENABLED
+
+#define RTPROF_BEGIN(r) rtprof_begin(r)
+#define RTPROF_END(r)   rtprof_end(r)
+
+void rtprof_begin(enum rtprof_region r);
+void rtprof_end(enum rtprof_region r);
+
+/**
+ * Clear the ring and the per-region totals.
+ */
+void rtprof_reset(void);
+
+/**
+ * Log one line per region called since the last reset, tagged with
+ * label (e.g. the workload name).
+ */
+void rtprof_summary(const char *label);
+
+/**
+ * Log the events in the ring, oldest first, as "<ticks> +|-<region>".
+ */
+void rtprof_dump(void);
+
+#else /* RTPROF_ENABLED */
+
+#define RTPROF_BEGIN(r) do { } while(0)
+#define RTPROF_END(r)   do { } while(0)
+
+static inline void rtprof_reset(void) { }
+static inline void rtprof_summary(const char *label) { (void)label; }
+static inline void rtprof_dump(void) { }
+
+#endif /* RTPROF_ENABLED */
+
+#endif /* RTPROF_H */
@@ -0,0 +1,21 @@
+/* record.c */
+#include "record.h"
+#include "contiki.h"
+#include "sys/energest.h"
+#include "sys/log.h"
+#include <inttypes.h>
+
+#define LOG_MODULE "CryptoRec"
+#define LOG_LEVEL  LOG_LEVEL_INFO
+
+void record_log(const struct record *r) {
+  LOG_INFO("rec1,%s,%s,%s,%lu,%lu,%u,%lu,%" PRIu64 ",%" PRIu64 ",%" PRIu64
+           ",%" PRIu64 ",",
+           RECORD_TARGET, RECORD_BUILD, r->workload, r->payload, r->iter,
+           r->round, (unsigned long)ENERGEST_SECOND,
+           r->cpu, r->lpm, r->tx, r->rx);
+  if(r->aead != RECORD_NO_AEAD) {
+    LOG_INFO_("%lu", (unsigned long)r->aead);
+  }
+  LOG_INFO_("\n");
+}
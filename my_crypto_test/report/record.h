@@ -0,0 +1,54 @@
+/* record.h */
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdint.h>
+
+/*
+ * Machine-readable benchmark records on the serial log.
+ *
+ * Every measurement window is logged as one CSV line, next to the
+ * human-readable Energest block, so host tools need no state to parse
+ * it (cooja/aggregate.py):
+ *
+ *   rec1,target,build,workload,payload,iter,round,ticks_s,cpu,lpm,tx,rx,aead
+ *
+ *   target    TARGET the firmware was built for (sky, z1, native)
+ *   build     compiler knobs, the config name of cooja/opt_matrix.sh or
+ *             "default"
+ *   workload  e.g. "aes-ccm*"; the cipher is the part before the '-'
+ *   payload   bytes handled per iteration
+ *   iter      iterations in the window (packets for my_crypto_net)
+ *   round     window number since boot, from 1
+ *   ticks_s   Energest ticks per second
+ *   cpu..rx   Energest ticks per state in the window
+ *   aead      ticks spent in the AEAD calls, empty if not measured
+ *
+ * "rec1" is the format version; a new field means a new version.
+ */
+
+#ifndef RECORD_TARGET
+#define RECORD_TARGET "unknown"
+#endif
+#ifndef RECORD_BUILD
+#define RECORD_BUILD "default"
+#endif
+
+/* aead value of records without a separate AEAD measurement */
+#define RECORD_NO_AEAD UINT32_MAX
+
+struct record {
+  const char *workload;
+  unsigned long payload;
+  unsigned long iter;
+  unsigned round;
+  uint64_t cpu, lpm, tx, rx;
+  uint32_t aead;
+};
+
+/**
+ * Log r as one rec1 line.
+ */
+void record_log(const struct record *r);
+
+#endif /* RECORD_H */
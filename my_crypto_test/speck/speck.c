@@ -1,5 +1,6 @@
 /* speck.c */
 #include "speck.h"
+#include "rtprof.h"
 
 /* 64-bit circular rotates */
 static inline uint64_t rotr64(uint64_t x, unsigned r) {
@@ -30,40 +31,52 @@ static inline uint64_t rotl64(uint64_t x, unsigned r) {
   } while(0)
 
 void speck_key_expand(const uint64_t k[2],
-                      uint64_t subkeys[2 * SPECK_ROUNDS])
+                      uint64_t subkeys[SPECK_ROUNDS])
 {
   uint64_t a = k[0], b = k[1];
+  RTPROF_BEGIN(RTPROF_SPECK_KEY);
   for(unsigned i = 0; i < SPECK_ROUNDS; i++) {
-    subkeys[2*i]     = b;
-    subkeys[2*i + 1] = a;
+    subkeys[i] = a;
     R(b, a, i);
   }
+  RTPROF_END(RTPROF_SPECK_KEY);
 }
 
-void speck_encrypt(const uint64_t pt[2],
-                   uint64_t ct[2],
-                   const uint64_t key[2])
+void speck_encrypt_block(const uint64_t pt[2],
+                         uint64_t ct[2],
+                         const uint64_t subkeys[SPECK_ROUNDS])
 {
   uint64_t x = pt[1], y = pt[0];
-  uint64_t sub[2 * SPECK_ROUNDS];
-  speck_key_expand(key, sub);
+  RTPROF_BEGIN(RTPROF_SPECK_ROUNDS);
   for(unsigned i = 0; i < SPECK_ROUNDS; i++) {
-    R(x, y, sub[2*i + 1]);
+    R(x, y, subkeys[i]);
   }
+  RTPROF_END(RTPROF_SPECK_ROUNDS);
   ct[1] = x;
   ct[0] = y;
 }
 
+void speck_encrypt(const uint64_t pt[2],
+                   uint64_t ct[2],
+                   const uint64_t key[2])
+{
+  uint64_t sub[SPECK_ROUNDS];
+  speck_key_expand(key, sub);
+  speck_encrypt_block(pt, ct, sub);
+}
+
 void speck_decrypt(const uint64_t ct[2],
                    uint64_t pt[2],
                    const uint64_t key[2])
 {
   uint64_t x = ct[1], y = ct[0];
-  uint64_t sub[2 * SPECK_ROUNDS];
+  uint64_t sub[SPECK_ROUNDS];
   speck_key_expand(key, sub);
+  RTPROF_BEGIN(RTPROF_SPECK_ROUNDS);
   for(int i = SPECK_ROUNDS - 1; i >= 0; i--) {
-    D(x, y, sub[2*i + 1]);
+    D(x, y, sub[i]);
   }
+  RTPROF_END(RTPROF_SPECK_ROUNDS);
   pt[1] = x;
   pt[0] = y;
 }
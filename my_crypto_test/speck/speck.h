@@ -8,13 +8,25 @@
 #define SPECK_ROUNDS 32
 
 /**
- * Expand a 128-bit key (2×64-bit words) into the 2×SPECK_ROUNDS round keys.
+ * Expand a 128-bit key (2×64-bit words) into the SPECK_ROUNDS round keys.
  *
  * @param k        Input key as two 64-bit words.
- * @param subkeys  Output buffer of length 2*SPECK_ROUNDS.
+ * @param subkeys  Output buffer of length SPECK_ROUNDS.
  */
 void speck_key_expand(const uint64_t k[2],
-                      uint64_t subkeys[2 * SPECK_ROUNDS]);
+                      uint64_t subkeys[SPECK_ROUNDS]);
+
+/**
+ * Encrypt one 128-bit block with an already expanded key schedule.
+ * Used by the block-cipher modes, which expand the key once per message.
+ *
+ * @param pt       Input plaintext as two little-endian 64-bit words.
+ * @param ct       Output ciphertext (same format).
+ * @param subkeys  Round keys produced by speck_key_expand().
+ */
+void speck_encrypt_block(const uint64_t pt[2],
+                         uint64_t ct[2],
+                         const uint64_t subkeys[SPECK_ROUNDS]);
 
 /**
  * Encrypt one 128-bit block under the given 128-bit key.
@@ -0,0 +1,227 @@
+/* enc_log.c */
+#include "enc_log.h"
+#include "ascon.h"
+#include "ccm_star.h"
+#include "rtprof.h"
+#include "cfs/cfs.h"
+#if ENC_LOG_COFFEE
+#include "cfs/cfs-coffee.h"
+#endif
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/*  Internal helpers (static)                                         */
+/* ------------------------------------------------------------------ */
+
+#define DATA(log) ((log)->page + ENC_LOG_HDR_LEN)
+#define TAG(log)  ((log)->page + ENC_LOG_HDR_LEN + ENC_LOG_DATA_LEN)
+
+/* ASCON-128 nonces are 16 bytes, CCM* ones at most 13 */
+#define NONCE_MAX ASCON_128_NONCE_LEN
+
+/* header byte 6 */
+#define FLAG_LAST 0x01    /* end page written by enc_log_close() */
+
+/* whole 8-byte blocks: ASCON's rate and PRESENT's block */
+typedef char enc_log_data_len_check[ENC_LOG_DATA_LEN % 8 == 0 ? 1 : -1];
+
+static void setup(struct enc_log *log, enum enc_log_cipher cipher,
+                  const uint8_t key[16], uint32_t id) {
+  log->cipher = cipher;
+  log->id     = id;
+  log->seq    = 0;
+  log->fill   = 0;
+  log->avail  = 0;
+  log->writing = 0;
+  log->last   = 0;
+  switch(cipher) {
+  case ENC_LOG_ASCON:
+    memcpy(log->ascon_key, key, sizeof(log->ascon_key));
+    break;
+  case ENC_LOG_AES:
+    block_cipher_init(&log->bc, &block_cipher_aes, key);
+    break;
+  case ENC_LOG_SPECK:
+    block_cipher_init(&log->bc, &block_cipher_speck, key);
+    break;
+  case ENC_LOG_PRESENT:
+    block_cipher_init(&log->bc, &block_cipher_present, key);
+    break;
+  }
+}
+
+/* seq || id || 0..., truncated to the cipher's nonce length */
+static void make_nonce(const struct enc_log *log, uint8_t nonce[NONCE_MAX]) {
+  uint8_t len = log->cipher == ENC_LOG_ASCON ? ASCON_128_NONCE_LEN
+              : CCM_STAR_NONCE_LEN(log->bc.cipher->block_len);
+  memset(nonce, 0, NONCE_MAX);
+  for(int i = 0; i < 4; i++) {
+    nonce[i]     = log->seq >> (24 - 8 * i);
+    if(4 + i < len) {
+      nonce[4 + i] = log->id >> (8 * i);
+    }
+  }
+}
+
+static void seal_page(struct enc_log *log, uint8_t flags) {
+  uint8_t *h = log->page;
+  uint8_t nonce[NONCE_MAX];
+
+  h[0] = log->seq >> 24;  h[1] = log->seq >> 16;
+  h[2] = log->seq >> 8;   h[3] = log->seq;
+  h[4] = log->fill >> 8;  h[5] = log->fill;
+  h[6] = flags;
+  h[7] = 0;
+  memset(DATA(log) + log->fill, 0, ENC_LOG_DATA_LEN - log->fill);
+
+  make_nonce(log, nonce);
+  if(log->cipher == ENC_LOG_ASCON) {
+    ascon128_encrypt(log->ascon_key, nonce, h, ENC_LOG_HDR_LEN,
+                     DATA(log), ENC_LOG_DATA_LEN, DATA(log),
+                     TAG(log), ENC_LOG_TAG_LEN);
+  } else {
+    ccm_star_encrypt(&log->bc, nonce, h, ENC_LOG_HDR_LEN,
+                     DATA(log), ENC_LOG_DATA_LEN, TAG(log), ENC_LOG_TAG_LEN);
+  }
+}
+
+/* Returns 0 if the page at log->seq decrypted and verified */
+static int open_page(struct enc_log *log) {
+  const uint8_t *h = log->page;
+  uint8_t nonce[NONCE_MAX];
+  uint32_t seq = ((uint32_t)h[0] << 24) | ((uint32_t)h[1] << 16)
+               | ((uint32_t)h[2] << 8) | h[3];
+  uint16_t len = ((uint16_t)h[4] << 8) | h[5];
+
+  if(seq != log->seq || len > ENC_LOG_DATA_LEN ||
+     (h[6] & ~FLAG_LAST) || h[7]) {
+    return -1;
+  }
+
+  make_nonce(log, nonce);
+  if(log->cipher == ENC_LOG_ASCON) {
+    if(ascon128_decrypt(log->ascon_key, nonce, h, ENC_LOG_HDR_LEN,
+                        DATA(log), ENC_LOG_DATA_LEN, DATA(log),
+                        TAG(log), ENC_LOG_TAG_LEN) != 0) {
+      /* do not leave unauthenticated plaintext in the page buffer */
+      memset(DATA(log), 0, ENC_LOG_DATA_LEN);
+      return -1;
+    }
+  } else {
+    if(ccm_star_decrypt(&log->bc, nonce, h, ENC_LOG_HDR_LEN,
+                        DATA(log), ENC_LOG_DATA_LEN,
+                        TAG(log), ENC_LOG_TAG_LEN) != 0) {
+      return -1;
+    }
+  }
+  log->avail = len;
+  log->fill  = 0;
+  log->last  = h[6] & FLAG_LAST;
+  return 0;
+}
+
+static int write_page(struct enc_log *log, uint8_t flags) {
+  int n;
+  seal_page(log, flags);
+  RTPROF_BEGIN(RTPROF_LOG_FLASH);
+  n = cfs_write(log->fd, log->page, ENC_LOG_PAGE_LEN);
+  RTPROF_END(RTPROF_LOG_FLASH);
+  if(n != ENC_LOG_PAGE_LEN) {
+    return -1;
+  }
+  log->seq++;
+  log->fill = 0;
+  return 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Public API implementations                                        */
+/* ------------------------------------------------------------------ */
+
+int enc_log_create(struct enc_log *log, const char *name,
+                   enum enc_log_cipher cipher, const uint8_t key[16],
+                   uint32_t id, uint32_t size) {
+  setup(log, cipher, key, id);
+  log->fd = -1;
+  cfs_remove(name);
+#if ENC_LOG_COFFEE
+  /* a file that is not reserved grows page by page, and the extra
+     garbage collection would be charged to every stored byte */
+  if(size && cfs_coffee_reserve(name, size) < 0) {
+    return -1;
+  }
+#else
+  (void)size;
+#endif
+  log->writing = 1;
+  log->fd = cfs_open(name, CFS_WRITE | CFS_APPEND);
+  return log->fd < 0 ? -1 : 0;
+}
+
+int enc_log_append(struct enc_log *log, const void *data, size_t len) {
+  const uint8_t *p = data;
+  while(len) {
+    size_t n = ENC_LOG_DATA_LEN - log->fill;
+    if(n > len) n = len;
+    memcpy(DATA(log) + log->fill, p, n);
+    log->fill += n;
+    p   += n;
+    len -= n;
+    if(log->fill == ENC_LOG_DATA_LEN && write_page(log, 0) != 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int enc_log_close(struct enc_log *log) {
+  int ret = 0;
+  /* always seal an end page, even an empty one, so readers can tell
+     a complete log from a truncated one */
+  if(log->writing && write_page(log, FLAG_LAST) != 0) {
+    ret = -1;
+  }
+  cfs_close(log->fd);
+  log->fd = -1;
+  return ret;
+}
+
+int enc_log_open(struct enc_log *log, const char *name,
+                 enum enc_log_cipher cipher, const uint8_t key[16],
+                 uint32_t id) {
+  setup(log, cipher, key, id);
+  log->fd = cfs_open(name, CFS_READ);
+  return log->fd < 0 ? -1 : 0;
+}
+
+int enc_log_read(struct enc_log *log, void *buf, size_t len) {
+  uint8_t *p = buf;
+  size_t done = 0;
+  int got;
+
+  while(done < len) {
+    if(log->fill == log->avail) {
+      /* current page used up: stop after the end page, else fetch and
+         verify the next one */
+      if(log->last) {
+        break;
+      }
+      if(log->avail) {
+        log->seq++;
+      }
+      RTPROF_BEGIN(RTPROF_LOG_FLASH);
+      got = cfs_read(log->fd, log->page, ENC_LOG_PAGE_LEN);
+      RTPROF_END(RTPROF_LOG_FLASH);
+      /* running out of pages before the end page means truncation */
+      if(got != ENC_LOG_PAGE_LEN || open_page(log) != 0) {
+        return -1;
+      }
+    }
+    size_t n = log->avail - log->fill;
+    if(n > len - done) n = len - done;
+    memcpy(p + done, DATA(log) + log->fill, n);
+    log->fill += n;
+    done += n;
+  }
+  return done;
+}
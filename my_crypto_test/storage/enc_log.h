@@ -0,0 +1,122 @@
+/* enc_log.h */
+#ifndef ENC_LOG_H
+#define ENC_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "block_cipher.h"
+
+/*
+ * Encrypted append-only log on a CFS (Coffee) file.
+ *
+ * Records are buffered into one RAM page; every full page is sealed
+ * (AEAD) and written with a single cfs_write(), so nothing larger than
+ * a page is ever held in RAM. On flash each page is:
+ *
+ *   | seq (4, BE) | len (2, BE) | flags (1) | 0 (1) | data | tag |
+ *
+ * The 8-byte header is authenticated, the data area is encrypted and
+ * the page number doubles as the nonce, so pages cannot be reordered.
+ * enc_log_close() always seals a final page (possibly empty) flagged
+ * as the end of the log, so a reader can tell a complete log from one
+ * whose trailing pages were cut off. A log that was never closed, e.g.
+ * after a reset, has no end page and reads as truncated once its
+ * pages are used up.
+ * ASCON-128 and CCM* nonces are seq (BE) || id (LE) || 0..., truncated
+ * to the cipher's nonce length; the id goes low byte first so
+ * PRESENT's 5-byte nonce keeps it.
+ */
+
+/* Flash page size of the M25P80 on sky and z1 */
+#ifndef ENC_LOG_CONF_PAGE_LEN
+#define ENC_LOG_PAGE_LEN 256
+#else
+#define ENC_LOG_PAGE_LEN ENC_LOG_CONF_PAGE_LEN
+#endif
+
+/* Coffee reservation; the Makefile enables it where Coffee is the CFS
+   backend (not on native, which stores CFS files as POSIX files) */
+#ifdef ENC_LOG_CONF_COFFEE
+#define ENC_LOG_COFFEE ENC_LOG_CONF_COFFEE
+#else
+#define ENC_LOG_COFFEE 0
+#endif
+
+#define ENC_LOG_HDR_LEN  8
+#define ENC_LOG_TAG_LEN  8
+#define ENC_LOG_DATA_LEN (ENC_LOG_PAGE_LEN - ENC_LOG_HDR_LEN - ENC_LOG_TAG_LEN)
+
+enum enc_log_cipher {
+  ENC_LOG_ASCON,
+  ENC_LOG_AES,
+  ENC_LOG_SPECK,
+  ENC_LOG_PRESENT
+};
+
+struct enc_log {
+  int fd;
+  enum enc_log_cipher cipher;
+  uint32_t id;        /* log identifier, part of the nonce */
+  uint32_t seq;       /* page currently being filled / read */
+  uint16_t fill;      /* write: bytes buffered, read: bytes consumed */
+  uint16_t avail;     /* read: payload bytes in the current page */
+  uint8_t writing;    /* opened by enc_log_create() */
+  uint8_t last;       /* read: the current page is the end page */
+  uint8_t ascon_key[16];
+  struct block_cipher_ctx bc;
+  uint8_t page[ENC_LOG_PAGE_LEN];
+};
+
+/**
+ * enc_log_create(log, name, cipher, key, id):
+ *   - name:    CFS file name; an existing file is replaced
+ *   - cipher:  one of enum enc_log_cipher
+ *   - key:     16 bytes (PRESENT uses the first 10)
+ *   - id:      log identifier, must be unique per key
+ *   - size:    bytes to reserve in Coffee (0 = Coffee default); unused
+ *              without ENC_LOG_COFFEE
+ *
+ * Returns 0, or -1 if the reservation fails or the file cannot be
+ * opened.
+ */
+int enc_log_create(struct enc_log *log, const char *name,
+                   enum enc_log_cipher cipher, const uint8_t key[16],
+                   uint32_t id, uint32_t size);
+
+/**
+ * enc_log_append(log, data, len):
+ *
+ * Append len bytes; a page is sealed and written each time one fills.
+ * Returns 0, or -1 on a write error.
+ */
+int enc_log_append(struct enc_log *log, const void *data, size_t len);
+
+/**
+ * enc_log_close(log):
+ *
+ * Seal and write the end page with any buffered bytes and close the
+ * file. Logs opened with enc_log_open() are just closed.
+ */
+int enc_log_close(struct enc_log *log);
+
+/**
+ * enc_log_open(log, name, cipher, key, id):
+ *
+ * Open an existing log for reading with the parameters it was
+ * created with. Returns 0, or -1 if the file cannot be opened.
+ */
+int enc_log_open(struct enc_log *log, const char *name,
+                 enum enc_log_cipher cipher, const uint8_t key[16],
+                 uint32_t id);
+
+/**
+ * enc_log_read(log, buf, len):
+ *
+ * Read up to len decrypted bytes. Returns the number of bytes read,
+ * 0 after the end page, or -1 if a page fails authentication or the
+ * file ends before the end page (truncated or never closed).
+ */
+int enc_log_read(struct enc_log *log, void *buf, size_t len);
+
+#endif /* ENC_LOG_H */
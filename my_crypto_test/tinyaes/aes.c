@@ -2,6 +2,7 @@
 
 #include <string.h>     // for memcpy, memset
 #include "aes.h"
+#include "rtprof.h"
 
 // Number of columns comprising a state in AES
 #define Nb 4
@@ -53,6 +54,7 @@ static void KeyExpansion(uint8_t *RoundKey, const uint8_t *Key) {
   uint8_t tempa[4];
   int i, j;
 
+  RTPROF_BEGIN(RTPROF_AES_KEY);
   // first round key = Key
   for(i = 0; i < Nk; ++i) {
     RoundKey[4*i + 0] = Key[4*i + 0];
@@ -81,6 +83,7 @@ static void KeyExpansion(uint8_t *RoundKey, const uint8_t *Key) {
       RoundKey[4*i + j] = RoundKey[4*(i-Nk) + j] ^ tempa[j];
     }
   }
+  RTPROF_END(RTPROF_AES_KEY);
 }
 
 void AES_init_ctx(struct AES_ctx *ctx, const uint8_t *key) {
@@ -151,7 +154,25 @@ static void MixColumns(state_t state) {
   }
 }
 
+/* Bytes are column-major in AES (FIPS-197 3.4): in[r + 4c] -> state[r][c] */
+static void LoadState(state_t state, const uint8_t *buf) {
+  RTPROF_BEGIN(RTPROF_AES_COPY);
+  for(int c=0; c<4; c++)
+    for(int r=0; r<4; r++)
+      state[r][c] = buf[4*c + r];
+  RTPROF_END(RTPROF_AES_COPY);
+}
+
+static void StoreState(uint8_t *buf, state_t state) {
+  RTPROF_BEGIN(RTPROF_AES_COPY);
+  for(int c=0; c<4; c++)
+    for(int r=0; r<4; r++)
+      buf[4*c + r] = state[r][c];
+  RTPROF_END(RTPROF_AES_COPY);
+}
+
 static void Cipher(state_t state, const uint8_t *RoundKey) {
+  RTPROF_BEGIN(RTPROF_AES_ROUNDS);
   AddRoundKey(0, state, RoundKey);
   for(uint8_t round = 1; round < Nr; round++) {
     SubBytes(state);
@@ -163,17 +184,18 @@ static void Cipher(state_t state, const uint8_t *RoundKey) {
   SubBytes(state);
   ShiftRows(state);
   AddRoundKey(Nr, state, RoundKey);
+  RTPROF_END(RTPROF_AES_ROUNDS);
 }
 
 #if ECB == 1
 void AES_ECB_encrypt(const struct AES_ctx *ctx, uint8_t *buf) {
   state_t state;
   // load the 16 bytes into our 4×4 state matrix
-  memcpy(state, buf, AES_BLOCKLEN);
+  LoadState(state, buf);
   // run the core AES cipher on the matrix
   Cipher(state, ctx->RoundKey);
   // write the result back into the byte buffer
-  memcpy(buf, state, AES_BLOCKLEN);
+  StoreState(buf, state);
 }
 void AES_ECB_decrypt(const struct AES_ctx *ctx, uint8_t *buf) {
   // InvCipher not shown here; assume present if needed
@@ -187,16 +209,19 @@ static void XorWithIv(uint8_t *buf, const uint8_t *Iv) {
 void AES_CBC_encrypt_buffer(struct AES_ctx *ctx, uint8_t *buf, size_t length) {
   uint8_t *Iv = ctx->Iv;
   state_t state;
-  
+
+  RTPROF_BEGIN(RTPROF_AES_CBC);
   for(size_t i=0;i<length;i+=AES_BLOCKLEN) {
     XorWithIv(buf, Iv);
-    memcpy(state, buf, AES_BLOCKLEN);
+    LoadState(state, buf);
     Cipher(state, ctx->RoundKey);
+    StoreState(buf, state);
     Iv = buf;
     buf += AES_BLOCKLEN;
   }
-  memcpy(buf, state, AES_BLOCKLEN);
+  // keep the last ciphertext block as IV so calls can be chained
   memcpy(ctx->Iv, Iv, AES_BLOCKLEN);
+  RTPROF_END(RTPROF_AES_CBC);
 }
 #endif
 
@@ -208,9 +233,9 @@ void AES_CTR_xcrypt_buffer(struct AES_ctx *ctx, uint8_t *buf, size_t length) {
   for(size_t i=0;i<length;i++) {
     if(bi == AES_BLOCKLEN) {
       memcpy(buffer, ctx->Iv, AES_BLOCKLEN);
-      memcpy(state, buf, AES_BLOCKLEN);
+      LoadState(state, buffer);
       Cipher(state, ctx->RoundKey);
-      memcpy(buf, state, AES_BLOCKLEN);
+      StoreState(buffer, state);
       // increment IV
       for(int j = AES_BLOCKLEN-1; j>=0; j--) {
         if(++ctx->Iv[j]!=0) break;